@@ -121,9 +121,11 @@ void showHelp(const char* argv0)
 		{ "depends", __("prints dependencies of binary package(s)") },
 		{ "rdepends", __("print reverse-dependencies of binary package(s)") },
 		{ "why", __("finds a dependency path between a package set and a package") },
+		{ "check-installability", __("checks whether binary package versions can be installed") },
 		{ "policy", __("prints the pin info for the binary package(s)") },
 		{ "policysrc", __("prints the pin info for the source package(s)") },
 		{ "pkgnames", __("prints available package names") },
+		{ "cache-stats", __("prints memory usage of the package cache") },
 		{ "changelog", __("views the Debian changelog(s) of binary package(s)") },
 		{ "copyright", __("views the Debian copyright(s) info of binary package(s)") },
 		{ "screenshots", __("views Debian screenshot web pages for binary package(s)") },
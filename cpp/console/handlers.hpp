@@ -30,7 +30,9 @@ int dumpConfig(Context&);
 int policy(Context&, bool);
 int shell(Context&);
 int showPackageNames(Context&);
+int showCacheMemoryUsage(Context&);
 int findDependencyChain(Context&);
+int checkInstallability(Context&);
 int updateReleaseAndIndexData(Context&);
 int downloadSourcePackage(Context&);
 int cleanArchives(Context&, bool);
@@ -0,0 +1,228 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                        *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <iostream>
+#include <cstdio>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../handlers.hpp"
+#include "../selectors.hpp"
+
+#include <cupt/system/resolvers/native.hpp>
+
+using std::cout;
+using std::endl;
+
+namespace {
+
+struct CheckResult
+{
+	bool installable;
+	string failureReason;
+};
+
+class Checker
+{
+	shared_ptr< const Config > p_config;
+	shared_ptr< const Cache > p_cache;
+	unique_ptr< NativeResolver > p_resolver;
+ public:
+	Checker(const shared_ptr< const Config >& config, const shared_ptr< const Cache >& cache)
+		: p_config(config), p_cache(cache), p_resolver(new NativeResolver(config, cache))
+	{}
+	CheckResult check(const BinaryVersion* version)
+	{
+		CheckResult result;
+		try
+		{
+			result.installable = p_resolver->checkInstallability(version, &result.failureReason);
+		}
+		catch (Exception&)
+		{
+			// the error is reported already
+			result.installable = false;
+			result.failureReason = __("the check failed") + string("\n");
+			// the failed check may have left the resolver in the middle of a search
+			p_resolver.reset(new NativeResolver(p_config, p_cache));
+		}
+		return result;
+	}
+};
+
+vector< CheckResult > checkSequentially(const shared_ptr< const Config >& config,
+		const shared_ptr< const Cache >& cache, const vector< const BinaryVersion* >& versions)
+{
+	vector< CheckResult > results;
+	Checker checker(config, cache);
+	for (auto version: versions)
+	{
+		results.push_back(checker.check(version));
+	}
+	return results;
+}
+
+void writeResult(FILE* file, size_t index, const CheckResult& result)
+{
+	fprintf(file, "%zu %d %zu\n", index, int(result.installable), result.failureReason.size());
+	fwrite(result.failureReason.data(), 1, result.failureReason.size(), file);
+}
+
+void readResults(FILE* file, vector< CheckResult >* results)
+{
+	rewind(file);
+
+	char header[64];
+	while (fgets(header, sizeof(header), file))
+	{
+		size_t index;
+		int installable;
+		size_t failureReasonSize;
+		if (sscanf(header, "%zu %d %zu", &index, &installable, &failureReasonSize) != 3 ||
+				index >= results->size())
+		{
+			fatal2i("check-installability: malformed result line '%s'", header);
+		}
+		auto& result = (*results)[index];
+		result.installable = installable;
+		result.failureReason.resize(failureReasonSize);
+		if (fread(&result.failureReason[0], 1, failureReasonSize, file) != failureReasonSize)
+		{
+			fatal2i("check-installability: truncated failure reason");
+		}
+	}
+}
+
+/* neither the cache nor the resolver may be used from several threads, so
+   every job is a process checking every 'jobCount'th version with its own
+   dependency graph; the parsed cache is shared with the parent until changed */
+vector< CheckResult > checkInParallel(const shared_ptr< const Config >& config,
+		const shared_ptr< const Cache >& cache, const vector< const BinaryVersion* >& versions,
+		size_t jobCount)
+{
+	cout.flush();
+
+	vector< pair< pid_t, FILE* > > jobs;
+	for (size_t jobIndex = 0; jobIndex < jobCount; ++jobIndex)
+	{
+		FILE* output = tmpfile();
+		if (!output)
+		{
+			fatal2e(__("unable to create a temporary file"));
+		}
+
+		auto pid = fork();
+		if (pid == -1)
+		{
+			fatal2e(__("unable to create a checker process: fork() failed"));
+		}
+		if (!pid)
+		{
+			// nothing may unwind into the code of the parent
+			try
+			{
+				Checker checker(config, cache);
+				for (size_t i = jobIndex; i < versions.size(); i += jobCount)
+				{
+					writeResult(output, i, checker.check(versions[i]));
+				}
+				_exit(fflush(output) == 0 ? 0 : 1);
+			}
+			catch (...)
+			{
+				_exit(1);
+			}
+		}
+		jobs.push_back({ pid, output });
+	}
+
+	vector< CheckResult > results(versions.size());
+	for (const auto& job: jobs)
+	{
+		int status;
+		if (waitpid(job.first, &status, 0) == -1)
+		{
+			fatal2e(__("%s() failed"), "waitpid");
+		}
+		if (!WIFEXITED(status) || WEXITSTATUS(status))
+		{
+			fatal2(__("the checker process %d failed"), int(job.first));
+		}
+		readResults(job.second, &results);
+		fclose(job.second);
+	}
+	return results;
+}
+
+}
+
+int checkInstallability(Context& context)
+{
+	auto config = context.getConfig();
+	vector< string > arguments;
+	bpo::options_description options("");
+	options.add_options()
+		("jobs", bpo::value< size_t >()->default_value(1));
+
+	auto variables = parseOptions(context, options, arguments);
+
+	if (arguments.empty())
+	{
+		fatal2(__("no binary package expressions specified"));
+	}
+	auto jobCount = variables["jobs"].as< size_t >();
+	if (!jobCount)
+	{
+		fatal2(__("the number of jobs must be positive"));
+	}
+
+	auto cache = context.getCache(
+			/* source */ any_of(arguments.begin(), arguments.end(), &isFunctionExpression),
+			/* binary */ true, /* installed */ true);
+
+	vector< const BinaryVersion* > versions;
+	for (const string& packageExpression: arguments)
+	{
+		auto selectedVersions = selectBinaryVersionsWildcarded(*cache, packageExpression);
+		versions.insert(versions.end(), selectedVersions.begin(), selectedVersions.end());
+	}
+
+	auto results = (jobCount == 1 || versions.size() <= 1) ?
+			checkSequentially(config, cache, versions) :
+			checkInParallel(config, cache, versions, std::min(jobCount, versions.size()));
+
+	bool allInstallable = true;
+	for (size_t i = 0; i < versions.size(); ++i)
+	{
+		auto version = versions[i];
+		const auto& result = results[i];
+		if (result.installable)
+		{
+			cout << format2(__("%s %s: installable"), version->packageName, version->versionString) << endl;
+		}
+		else
+		{
+			cout << format2(__("%s %s: not installable, because of:"), version->packageName, version->versionString) << endl;
+			cout << result.failureReason;
+			allInstallable = false;
+		}
+	}
+
+	return allInstallable ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
@@ -1631,7 +1631,7 @@ int managePackages(Context& context, ManagePackages::Mode mode)
 
 		auto downloadProgress = getDownloadProgress(*config);
 		cout << __("Performing requested actions:") << endl;
-		context.invalidate();
+		context.invalidateSystemState();
 		try
 		{
 			worker->changeSystem(downloadProgress);
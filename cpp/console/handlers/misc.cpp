@@ -675,6 +675,51 @@ int showPackageNames(Context& context)
 	return 0;
 }
 
+int showCacheMemoryUsage(Context& context)
+{
+	vector< string > arguments;
+	bpo::options_description options("");
+	options.add_options()
+		("parse-all", "");
+	auto variables = parseOptions(context, options, arguments);
+	checkNoExtraArguments(arguments);
+
+	auto cache = context.getCache(/* source */ true, /* binary */ true, /* installed */ true);
+
+	if (variables.count("parse-all"))
+	{
+		for (const string& packageName: cache->getBinaryPackageNames())
+		{
+			cache->getBinaryPackage(packageName);
+			cache->trimMemoryUsage();
+		}
+		for (const string& packageName: cache->getSourcePackageNames())
+		{
+			cache->getSourcePackage(packageName);
+			cache->trimMemoryUsage();
+		}
+	}
+
+	auto usage = cache->getMemoryUsage();
+	vector< pair< string, size_t > > lines = {
+		{ __("Unparsed package records"), usage.prePackages },
+		{ __("Parsed packages"), usage.packages },
+		{ __("Reverse provides"), usage.provides },
+		{ __("Satisfying versions cache"), usage.satisfyingVersions },
+		{ __("Localized descriptions"), usage.translations },
+		{ __("Pin cache"), usage.pins },
+	};
+	size_t total = 0;
+	for (const auto& line: lines)
+	{
+		cout << format2("%s: %s", line.first, humanReadableSizeString(line.second)) << endl;
+		total += line.second;
+	}
+	cout << format2("%s: %s", __("Total"), humanReadableSizeString(total)) << endl;
+
+	return 0;
+}
+
 int showScreenshotUris(Context& context)
 {
 	vector< string > arguments;
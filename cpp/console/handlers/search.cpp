@@ -119,6 +119,7 @@ void searchInPackageNamesAndDescriptions(const Cache& cache, const vector< strin
 				}
 			}
 		}
+		cache.trimMemoryUsage();
 	}
 }
 
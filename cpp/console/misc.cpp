@@ -246,7 +246,9 @@ std::function< int (Context&) > getHandler(const string& command)
 		{ "policysrc", [](Context& c) -> int { return policy(c, true); } },
 		{ "config-dump", &dumpConfig },
 		{ "pkgnames", &showPackageNames },
+		{ "cache-stats", &showCacheMemoryUsage },
 		{ "why", &findDependencyChain },
+		{ "check-installability", &checkInstallability },
 		{ "install", [](Context& c) -> int { return managePackages(c, ManagePackages::Install); } },
 		{ "remove", [](Context& c) -> int { return managePackages(c, ManagePackages::Remove); } },
 		{ "purge", [](Context& c) -> int { return managePackages(c, ManagePackages::Purge); } },
@@ -343,7 +345,7 @@ shared_ptr< Config > Context::getConfig()
 
 Context::Context()
 	: __used_source(false), __used_binary(false), __used_installed(false),
-	__valid(true)
+	__valid(true), __system_state_valid(true)
 {}
 
 shared_ptr< const Cache > Context::getCache(
@@ -364,12 +366,35 @@ shared_ptr< const Cache > Context::getCache(
 			__used_binary = useBinary;
 			__used_installed = useInstalled;
 			__valid = true;
+			__system_state_valid = true;
 		}
 		catch (Exception&)
 		{
 			fatal2(__("error while creating the package cache"));
 		}
 	}
+	else if (!__system_state_valid)
+	{
+		if (__used_installed)
+		{
+			try
+			{
+				__cache->refreshSystemState();
+			}
+			catch (Exception&)
+			{
+				__cache.reset();
+				fatal2(__("error while refreshing the package cache"));
+			}
+		}
+		__system_state_valid = true;
+	}
+
+	if (!needsRebuild)
+	{
+		// versions got by previous commands are not used anymore
+		__cache->trimMemoryUsage();
+	}
 
 	return __cache;
 }
@@ -381,4 +406,11 @@ void Context::invalidate()
 	__valid = false;
 }
 
+void Context::invalidateSystemState()
+{
+	if (__config && __config->getBool("cupt::worker::simulate"))
+		return;
+	__system_state_valid = false;
+}
+
 
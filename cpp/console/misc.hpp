@@ -33,6 +33,7 @@ class Context
 	bool __used_binary;
 	bool __used_installed;
 	bool __valid;
+	bool __system_state_valid;
  public:
 	Context();
 
@@ -40,6 +41,7 @@ class Context
 	shared_ptr< const Cache > getCache(
 			bool useSource, bool useBinary, bool useInstalled);
 	void invalidate();
+	void invalidateSystemState();
 
 	vector< string > unparsed;
 	int argc; // argc, argv - for exec() in distUpgrade()
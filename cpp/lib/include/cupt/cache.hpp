@@ -66,6 +66,17 @@ class CUPT_API Cache
 		set< string > automaticallyInstalled; ///< names of automatically installed packages
 	};
 
+	/// approximate memory usage of the cache structures, in bytes
+	struct MemoryUsage
+	{
+		size_t prePackages; ///< not yet parsed index records, keyed by package name
+		size_t packages; ///< parsed packages with their versions
+		size_t provides; ///< the reverse provides map
+		size_t satisfyingVersions; ///< memoized results of @ref getSatisfyingVersions
+		size_t translations; ///< the localized description map
+		size_t pins; ///< memoized results of @ref getPin
+	};
+
 	class PackageNameIterator
 	{
 	 public:
@@ -106,6 +117,18 @@ class CUPT_API Cache
 	/// destructor
 	virtual ~Cache();
 
+	/// re-reads the system state and extended info
+	/**
+	 * Use this instead of building a new cache when only installed packages
+	 * have changed. Package indexes are not re-read. The cache must be built
+	 * with @a useInstalled.
+	 *
+	 * @warning Pointers to binary packages and versions got from this cache
+	 * before the call become invalid if the installed record of the package
+	 * has changed.
+	 */
+	void refreshSystemState();
+
 	/// gets release data list of indexed metadata for binary packages
 	vector< shared_ptr< const ReleaseInfo > > getBinaryReleaseData() const;
 	/// gets release data list of indexed metadata for source packages
@@ -183,6 +206,18 @@ class CUPT_API Cache
 	 */
 	static string getPathOfChangelog(const BinaryVersion*);
 
+	/// gets approximate memory usage of the cache structures
+	MemoryUsage getMemoryUsage() const;
+	/// evicts least recently used packages to fit into the memory limit
+	/**
+	 * Does nothing unless the option @c cupt::cache::memory-limit is set.
+	 * Evicted packages will be re-parsed on the next request.
+	 *
+	 * @warning All pointers to packages and versions got from this cache
+	 * before the call may become invalid.
+	 */
+	void trimMemoryUsage() const;
+
 	/// controls internal caching
 	/**
 	 * If set to @c true, enables internal caching in methods @ref getPin and
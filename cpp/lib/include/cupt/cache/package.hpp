@@ -57,8 +57,8 @@ class CUPT_API Package
 {
 	vector< unique_ptr< Version > > __parsed_versions;
 
-	CUPT_LOCAL void __merge_version(const string&, unique_ptr< Version >&&);
-	CUPT_LOCAL void p_mergeInstalledVersion(unique_ptr< Version >&&);
+	CUPT_LOCAL const Version* __merge_version(const string&, unique_ptr< Version >&&);
+	CUPT_LOCAL const Version* p_mergeInstalledVersion(unique_ptr< Version >&&);
 
 	Package(const Package&);
 	Package& operator=(const Package&);
@@ -76,7 +76,7 @@ class CUPT_API Package
 	/// destructor
 	virtual ~Package();
 	/// @cond
-	CUPT_LOCAL void addEntry(const internal::VersionParseParameters&);
+	CUPT_LOCAL const Version* addEntry(const internal::VersionParseParameters&);
 	/// @endcond
 
 	/// gets list of versions
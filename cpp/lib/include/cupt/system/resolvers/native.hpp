@@ -48,6 +48,20 @@ class CUPT_API NativeResolver: public Resolver
 
 	bool resolve(Resolver::CallbackType);
 
+	/// checks whether a version can be installed on top of the system state
+	/**
+	 * The requests made before are not taken into account. The dependency
+	 * graph is kept between the calls, so checking many versions one after
+	 * another is much cheaper than resolving for each of them separately.
+	 * The tree search is used whatever the resolver type is.
+	 *
+	 * @param version
+	 * @param [out] failureReason the description of the failure, set only
+	 * if the version is not installable
+	 * @return @c true if there is a solution which installs @a version
+	 */
+	bool checkInstallability(const BinaryVersion* version, string* failureReason);
+
 	~NativeResolver();
 };
 
@@ -90,6 +90,11 @@ Cache::Cache(shared_ptr< const Config > config, bool useSource, bool useBinary,
 	__impl = new internal::CacheImpl;
 	__impl->config = config;
 	__impl->binaryArchitecture.reset(new string(config->getString("apt::architecture")));
+	auto memoryLimit = config->getInteger("cupt::cache::memory-limit");
+	if (memoryLimit > 0)
+	{
+		__impl->setMemoryLimit(memoryLimit * 1024);
+	}
 
 	__impl->parseSourcesLists();
 
@@ -105,9 +110,26 @@ Cache::Cache(shared_ptr< const Config > config, bool useSource, bool useBinary,
 
 Cache::~Cache()
 {
+	if (__impl->config->getBool("debug::cache"))
+	{
+		auto usage = __impl->getMemoryUsage();
+		debug2("memory usage: pre-packages: %zu, packages: %zu, provides: %zu, "
+				"satisfying versions: %zu, translations: %zu, pins: %zu",
+				usage.prePackages, usage.packages, usage.provides,
+				usage.satisfyingVersions, usage.translations, usage.pins);
+	}
 	delete __impl;
 }
 
+void Cache::refreshSystemState()
+{
+	if (!__impl->systemState)
+	{
+		fatal2i("refreshing the system state of a cache without installed packages");
+	}
+	__impl->refreshSystemState();
+}
+
 vector< shared_ptr< const ReleaseInfo > > Cache::getBinaryReleaseData() const
 {
 	return __impl->binaryReleaseData;
@@ -246,6 +268,16 @@ vector< const BinaryVersion* > Cache::getInstalledVersions() const
 	return result;
 }
 
+Cache::MemoryUsage Cache::getMemoryUsage() const
+{
+	return __impl->getMemoryUsage();
+}
+
+void Cache::trimMemoryUsage() const
+{
+	__impl->trimMemoryUsage();
+}
+
 const Cache::ExtendedInfo& Cache::getExtendedInfo() const
 {
 	return __impl->extendedInfo;
@@ -33,15 +33,16 @@ namespace cache {
 Package::Package()
 {}
 
-void Package::addEntry(const internal::VersionParseParameters& initParams)
+const Version* Package::addEntry(const internal::VersionParseParameters& initParams)
 {
 	try
 	{
-		__merge_version(*initParams.binaryArchitecturePtr, _parse_version(initParams));
+		return __merge_version(*initParams.binaryArchitecturePtr, _parse_version(initParams));
 	}
 	catch (Exception& e)
 	{
 		warn2(__("error while parsing a version for the package '%s'"), *initParams.packageNamePtr);
+		return nullptr;
 	}
 }
 
@@ -79,7 +80,7 @@ const string installedSuffix = "installed";
 
 }
 
-void Package::p_mergeInstalledVersion(unique_ptr<Version>&& parsedVersion)
+const Version* Package::p_mergeInstalledVersion(unique_ptr<Version>&& parsedVersion)
 {
 	if (!__parsed_versions.empty())
 	{
@@ -90,13 +91,14 @@ void Package::p_mergeInstalledVersion(unique_ptr<Version>&& parsedVersion)
 	// until for example #667665 is implemented
 	addVersionIdSuffix(&parsedVersion->versionString, installedSuffix);
 	__parsed_versions.push_back(std::move(parsedVersion));
+	return __parsed_versions.back().get();
 }
 
-void Package::__merge_version(const string& binaryArchitecture, unique_ptr< Version >&& parsedVersion)
+const Version* Package::__merge_version(const string& binaryArchitecture, unique_ptr< Version >&& parsedVersion)
 {
 	if (!_is_architecture_appropriate(binaryArchitecture, parsedVersion.get()))
 	{
-		return; // skip this version
+		return nullptr; // skip this version
 	}
 
 	// merging
@@ -104,14 +106,13 @@ void Package::__merge_version(const string& binaryArchitecture, unique_ptr< Vers
 	{
 		if (__is_installed(parsedVersion.get()))
 		{
-			p_mergeInstalledVersion(std::move(parsedVersion));
+			return p_mergeInstalledVersion(std::move(parsedVersion));
 		}
 		else
 		{
 			const auto& parsedVersionString = parsedVersion->versionString;
 
 			bool clashed = false;
-			bool merged = false;
 			for (const auto& presentVersion: __parsed_versions)
 			{
 				if (!getOriginalVersionString(presentVersion->versionString).equal(parsedVersionString))
@@ -127,8 +128,7 @@ void Package::__merge_version(const string& binaryArchitecture, unique_ptr< Vers
 				{
 					// ok, this is the same version, so adding new Version::Source info
 					presentVersion->sources.push_back(parsedVersion->sources[0]);
-					merged = true;
-					break;
+					return presentVersion.get();
 				}
 				else
 				{
@@ -136,15 +136,13 @@ void Package::__merge_version(const string& binaryArchitecture, unique_ptr< Vers
 				}
 			}
 
-			if (!merged)
+			if (clashed)
 			{
-				if (clashed)
-				{
-					static size_t idCounter = 0;
-					addVersionIdSuffix(&parsedVersion->versionString, format2("dhs%zu", idCounter++));
-				}
-				__parsed_versions.push_back(std::move(parsedVersion));
+				static size_t idCounter = 0;
+				addVersionIdSuffix(&parsedVersion->versionString, format2("dhs%zu", idCounter++));
 			}
+			__parsed_versions.push_back(std::move(parsedVersion));
+			return __parsed_versions.back().get();
 		}
 	}
 	catch (Exception&)
@@ -137,6 +137,7 @@ void ConfigImpl::initializeVariables()
 		// Cupt vars
 		{ "cupt::cache::limit-releases::by-archive::type", "none" },
 		{ "cupt::cache::limit-releases::by-codename::type", "none" },
+		{ "cupt::cache::memory-limit", "0" },
 		{ "cupt::cache::pin::addendums::downgrade", "-6000" },
 		{ "cupt::cache::pin::addendums::hold", "600000" },
 		{ "cupt::cache::pin::addendums::not-automatic", "-1700" },
@@ -196,13 +197,18 @@ void ConfigImpl::initializeVariables()
 		{ "cupt::update::generate-index-of-index", "yes" },
 		{ "cupt::update::use-index-diffs", "yes" },
 		{ "cupt::resolver::auto-remove", "yes" },
+		{ "cupt::resolver::drop-duplicate-solutions", "yes" },
 		{ "cupt::resolver::external-command", "" },
+		{ "cupt::resolver::graph-cache-directory", "" },
 		{ "cupt::resolver::keep-recommends", "yes" },
 		{ "cupt::resolver::keep-suggests", "no" },
 		{ "cupt::resolver::max-leaf-count", "-1" },
 		{ "cupt::resolver::max-solution-count", "32000" },
 		{ "cupt::resolver::no-remove", "no" },
+		{ "cupt::resolver::solution-cache-directory", "" },
 		{ "cupt::resolver::synchronize-by-source-versions", "none" },
+		{ "cupt::resolver::threads", "1" },
+		{ "cupt::resolver::time-limit", "0" },
 		{ "cupt::resolver::track-reasons", "no" },
 		{ "cupt::resolver::type", "fair" },
 		{ "cupt::resolver::score::new", "0" },
@@ -231,9 +237,11 @@ void ConfigImpl::initializeVariables()
 		{ "cupt::worker::purge", "no" },
 		{ "cupt::worker::simulate", "no" },
 		{ "cupt::worker::use-locks", "yes" },
+		{ "debug::cache", "no" },
 		{ "debug::downloader", "no" },
 		{ "debug::logger", "no" },
 		{ "debug::resolver", "no" },
+		{ "debug::resolver::statistics", "no" },
 		{ "debug::worker", "no" },
 		{ "debug::gpgv", "no" },
 	};
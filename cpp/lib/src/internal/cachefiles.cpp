@@ -18,6 +18,8 @@
 #include <clocale>
 #include <ctime>
 
+#include <unistd.h>
+
 #include <common/regex.hpp>
 
 #include <cupt/config.hpp>
@@ -568,7 +570,12 @@ void verifyReleaseValidityDate(const string& date, const Config& config, const s
 	}
 }
 
-shared_ptr< cache::ReleaseInfo > getReleaseInfo(const string& path, const string& alias)
+namespace {
+
+// suffix number must be incremented every time the format changes
+const string compactReleaseInfoSuffix = ".info" "0";
+
+shared_ptr< cache::ReleaseInfo > parseFullReleaseInfo(const string& path, const string& alias)
 {
 	shared_ptr< cache::ReleaseInfo > result(new cache::ReleaseInfo);
 	result->notAutomatic = false; // default
@@ -652,6 +659,119 @@ shared_ptr< cache::ReleaseInfo > getReleaseInfo(const string& path, const string
 	return result;
 }
 
+/* the compact form is a fixed sequence of lines: version, description,
+   vendor, label, archive, codename, date, valid-until date, space-separated
+   architectures and the NotAutomatic/ButAutomaticUpgrades flags as '0'/'1';
+   returns an empty pointer if the file is malformed */
+shared_ptr< cache::ReleaseInfo > parseCompactReleaseInfo(const string& path)
+{
+	const size_t lineCount = 10;
+	vector< string > lines;
+	{
+		RequiredFile file(path, "r");
+		string line;
+		while (lines.size() <= lineCount && !file.getLine(line).eof())
+		{
+			lines.push_back(line);
+		}
+	}
+	if (lines.size() != lineCount)
+	{
+		return nullptr;
+	}
+	const string& flags = lines[9];
+	if (flags.size() != 2 || flags.find_first_not_of("01") != string::npos)
+	{
+		return nullptr;
+	}
+
+	shared_ptr< cache::ReleaseInfo > result(new cache::ReleaseInfo);
+	result->version = lines[0];
+	result->description = lines[1];
+	result->vendor = lines[2];
+	result->label = lines[3];
+	result->archive = lines[4];
+	result->codename = lines[5];
+	result->date = lines[6];
+	result->validUntilDate = lines[7];
+	result->architectures = split(' ', lines[8]);
+	result->notAutomatic = (flags[0] == '1');
+	result->butAutomaticUpgrades = (flags[1] == '1');
+
+	return result;
+}
+
+}
+
+string getPathOfCompactReleaseInfo(const string& path)
+{
+	return path + compactReleaseInfoSuffix;
+}
+
+shared_ptr< cache::ReleaseInfo > getReleaseInfo(const string& path, const string& alias)
+{
+	auto compactPath = getPathOfCompactReleaseInfo(path);
+	if (fs::fileExists(compactPath) &&
+			fs::fileModificationTime(compactPath) >= fs::fileModificationTime(path))
+	{
+		shared_ptr< cache::ReleaseInfo > result;
+		try
+		{
+			result = parseCompactReleaseInfo(compactPath);
+		}
+		catch (Exception&)
+		{
+			fatal2(__("unable to parse the release '%s'"), alias);
+		}
+		if (result)
+		{
+			return result;
+		}
+
+		warn2(__("discarding the malformed compact release info '%s'"), compactPath);
+		// not checking the result: an unprivileged user may be unable to
+		// remove it, the full release is parsed anyway
+		unlink(compactPath.c_str());
+	}
+	return parseFullReleaseInfo(path, alias);
+}
+
+void removeCompactReleaseInfo(const string& path)
+{
+	auto compactPath = getPathOfCompactReleaseInfo(path);
+	if (fs::fileExists(compactPath))
+	{
+		if (unlink(compactPath.c_str()) == -1)
+		{
+			fatal2e(__("unable to remove the file '%s'"), compactPath);
+		}
+	}
+}
+
+void generateCompactReleaseInfo(const string& path, const string& temporaryPath)
+{
+	auto releaseInfo = parseFullReleaseInfo(path, path);
+	{
+		RequiredFile file(temporaryPath, "w");
+		auto putLine = [&file](const string& line)
+		{
+			file.put(line + '\n');
+		};
+
+		putLine(releaseInfo->version);
+		putLine(releaseInfo->description);
+		putLine(releaseInfo->vendor);
+		putLine(releaseInfo->label);
+		putLine(releaseInfo->archive);
+		putLine(releaseInfo->codename);
+		putLine(releaseInfo->date);
+		putLine(releaseInfo->validUntilDate);
+		putLine(join(" ", releaseInfo->architectures));
+		putLine(string(1, releaseInfo->notAutomatic ? '1' : '0') + (releaseInfo->butAutomaticUpgrades ? '1' : '0'));
+	}
+	fs::move(temporaryPath, getPathOfCompactReleaseInfo(path));
+}
+
 }
 }
 }
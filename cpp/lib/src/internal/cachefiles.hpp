@@ -58,6 +58,9 @@ vector< LocalizationDownloadRecord3 > getDownloadInfoOfLocalizedDescriptions3(
 		const Config&, const IndexEntry&);
 
 shared_ptr< cache::ReleaseInfo > getReleaseInfo(const string& path, const string& alias);
+string getPathOfCompactReleaseInfo(const string& path);
+void generateCompactReleaseInfo(const string& path, const string& temporaryPath);
+void removeCompactReleaseInfo(const string& path);
 void verifyReleaseValidityDate(const string& date, const Config& config, const string& alias);
 bool verifySignature(const Config&, const string& path, const string& alias);
 
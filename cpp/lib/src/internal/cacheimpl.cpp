@@ -38,12 +38,13 @@
 #include <internal/cachefiles.hpp>
 #include <internal/indexofindex.hpp>
 #include <internal/versionparse.hpp>
+#include <internal/memoryusage.hpp>
 
 namespace cupt {
 namespace internal {
 
 CacheImpl::CacheImpl()
-	: __smatch_ptr(new smatch)
+	: __smatch_ptr(new smatch), memoryLimit(0), packagesSize(0), satisfyingVersionsSize(0)
 {}
 
 CacheImpl::~CacheImpl()
@@ -51,19 +52,39 @@ CacheImpl::~CacheImpl()
 	delete __smatch_ptr;
 }
 
-void CacheImpl::processProvides(const string* packageNamePtr,
+namespace {
+
+// parses the optional " (= <version>)" part of the provides entry
+string getProvidedVersionString(const char* it, const char* end)
+{
+	auto skipSpaces = [&it, &end]()
+	{
+		while (it != end && *it == ' ') ++it;
+	};
+
+	skipSpaces();
+	if (it == end || *it != '(') return string();
+	++it;
+	skipSpaces();
+	if (it == end || *it != '=') return string();
+	++it;
+	skipSpaces();
+	auto versionStringEnd = std::find_if(it, end, [](char c) { return c == ' ' || c == ')'; });
+	return string(it, versionStringEnd);
+}
+
+}
+
+void CacheImpl::processProvides(const string* packageNamePtr, const PrePackageRecord& prePackageRecord,
 		const char* providesStringStart, const char* providesStringEnd)
 {
-	auto callback = [this, &packageNamePtr](const char* tokenBeginIt, const char* tokenEndIt)
+	auto callback = [this, &packageNamePtr, &prePackageRecord](const char* tokenBeginIt, const char* tokenEndIt)
 	{
 		const char* packageNameEndIt;
 		consumePackageName(tokenBeginIt, tokenEndIt, packageNameEndIt);
 
-		auto& sublist = this->canProvide[string(tokenBeginIt, packageNameEndIt)];
-		if (std::find(sublist.begin(), sublist.end(), packageNamePtr) == sublist.end())
-		{
-			sublist.push_back(packageNamePtr);
-		}
+		this->canProvide[string(tokenBeginIt, packageNameEndIt)].push_back(ReverseProvidesRecord {
+				packageNamePtr, prePackageRecord, getProvidedVersionString(packageNameEndIt, tokenEndIt) });
 	};
 	parse::processSpaceCharSpaceDelimitedStrings(
 			providesStringStart, providesStringEnd, ',', callback);
@@ -79,13 +100,23 @@ Package* CacheImpl::newSourcePackage() const
 	return new SourcePackage();
 }
 
+bool CacheImpl::isRecordVersionLess(const RecordVersion& left, const RecordVersion& right)
+{
+	return std::tie(left.prePackageRecord.releaseInfoAndFile, left.prePackageRecord.offset) <
+			std::tie(right.prePackageRecord.releaseInfoAndFile, right.prePackageRecord.offset);
+}
+
 Package* CacheImpl::preparePackage(unordered_map< string, vector< PrePackageRecord > >& pre,
-		unordered_map< string, unique_ptr< Package > >& target, const string& packageName,
+		PackageMap& target, const string& packageName,
 		decltype(&CacheImpl::newBinaryPackage) packageBuilderMethod) const
 {
 	auto targetIt = target.find(packageName);
 	if (targetIt != target.end())
 	{
+		if (memoryLimit)
+		{
+			touchPackage(target, packageName, targetIt->second.get());
+		}
 		return targetIt->second.get();
 	}
 
@@ -99,15 +130,38 @@ Package* CacheImpl::preparePackage(unordered_map< string, vector< PrePackageReco
 		versionInitParams.packageNamePtr = &packageName;
 		versionInitParams.binaryArchitecturePtr = binaryArchitecture.get();
 
+		// binary versions are remembered per record for reverse provides lookups
+		vector< RecordVersion >* recordVersions = (&target == &binaryPackages) ?
+				&versionsByPrePackageRecord[package.get()] : nullptr;
+
 		vector< PrePackageRecord >& preRecord = preIt->second;
 		FORIT(preRecordIt, preRecord)
 		{
 			versionInitParams.releaseInfo = preRecordIt->releaseInfoAndFile->first.get();
 			versionInitParams.file = preRecordIt->releaseInfoAndFile->second.get();
 			versionInitParams.offset = preRecordIt->offset;
-			package->addEntry(versionInitParams);
+			auto version = package->addEntry(versionInitParams);
+			if (recordVersions)
+			{
+				recordVersions->push_back(RecordVersion {
+						*preRecordIt, static_cast< const BinaryVersion* >(version) });
+			}
+		}
+		if (recordVersions)
+		{
+			std::sort(recordVersions->begin(), recordVersions->end(), isRecordVersionLess);
+		}
+		// with a memory limit the records are kept to be able to re-parse the
+		// package after eviction; the records of binary packages stay in
+		// versionsByPrePackageRecord anyway, see CacheImpl::refreshSystemState
+		if (memoryLimit)
+		{
+			touchPackage(target, packageName, package.get());
+		}
+		else
+		{
+			vector< PrePackageRecord >().swap(preRecord);
 		}
-		preRecord.clear();
 		return package.get();
 	}
 	else
@@ -116,6 +170,202 @@ Package* CacheImpl::preparePackage(unordered_map< string, vector< PrePackageReco
 	}
 }
 
+void CacheImpl::touchPackage(PackageMap& storage, const string& packageName, const Package* package) const
+{
+	auto insertResult = packageLruPositions.insert({ package, packageLru.end() });
+	auto& position = insertResult.first->second;
+	if (insertResult.second)
+	{
+		auto size = memoryusage::of(*package) + sizeof(*package);
+		packageLru.push_front(PackageLruRecord { &storage, &storage.find(packageName)->first, size });
+		packagesSize += size;
+	}
+	else
+	{
+		packageLru.splice(packageLru.begin(), packageLru, position);
+	}
+	position = packageLru.begin();
+}
+
+void CacheImpl::dropPackage(PackageMap& storage, PackageMap::iterator packageIt) const
+{
+	const Package* package = packageIt->second.get();
+
+	for (auto version: *package)
+	{
+		pinCache.erase(version);
+	}
+	if (&storage == &binaryPackages)
+	{
+		// cached lists may point to versions of this package
+		if (memoryLimit)
+		{
+			auto keysIt = satisfyingVersionsKeysByPackage.find(package);
+			while (keysIt != satisfyingVersionsKeysByPackage.end())
+			{
+				eraseSatisfyingVersions(getSatisfyingVersionsCache.find(*keysIt->second.back()));
+				keysIt = satisfyingVersionsKeysByPackage.find(package);
+			}
+		}
+		else
+		{
+			dropSatisfyingVersionsCache();
+		}
+	}
+
+	versionsByPrePackageRecord.erase(package);
+
+	auto lruPositionIt = packageLruPositions.find(package);
+	if (lruPositionIt != packageLruPositions.end())
+	{
+		packagesSize -= lruPositionIt->second->size;
+		packageLru.erase(lruPositionIt->second);
+		packageLruPositions.erase(lruPositionIt);
+	}
+	storage.erase(packageIt);
+}
+
+void CacheImpl::dropSatisfyingVersionsCache() const
+{
+	getSatisfyingVersionsCache.clear();
+	satisfyingVersionsLru.clear();
+	satisfyingVersionsKeysByPackage.clear();
+	satisfyingVersionsSize = 0;
+}
+
+vector< const Package* > CacheImpl::getPackagesOfVersions(const vector< const BinaryVersion* >& versions) const
+{
+	vector< const Package* > result;
+	for (auto version: versions)
+	{
+		result.push_back(binaryPackages.find(version->packageName)->second.get());
+	}
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+	return result;
+}
+
+void CacheImpl::addSatisfyingVersionsToLru(SatisfyingVersionsCache::iterator it) const
+{
+	auto packages = getPackagesOfVersions(it->second.versions);
+	for (auto package: packages)
+	{
+		satisfyingVersionsKeysByPackage[package].push_back(&it->first);
+	}
+
+	satisfyingVersionsLru.push_front(&it->first);
+	it->second.lruPosition = satisfyingVersionsLru.begin();
+	it->second.size = memoryusage::of(it->first) + memoryusage::ofVectorBuffer(it->second.versions) +
+			packages.size() * sizeof(const string*);
+	satisfyingVersionsSize += it->second.size;
+}
+
+void CacheImpl::eraseSatisfyingVersions(SatisfyingVersionsCache::iterator it) const
+{
+	for (auto package: getPackagesOfVersions(it->second.versions))
+	{
+		auto keysIt = satisfyingVersionsKeysByPackage.find(package);
+		auto& keys = keysIt->second;
+		keys.erase(std::find(keys.begin(), keys.end(), &it->first));
+		if (keys.empty())
+		{
+			satisfyingVersionsKeysByPackage.erase(keysIt);
+		}
+	}
+
+	satisfyingVersionsSize -= it->second.size;
+	satisfyingVersionsLru.erase(it->second.lruPosition);
+	getSatisfyingVersionsCache.erase(it);
+}
+
+void CacheImpl::evictLeastRecentlyUsedPackage() const
+{
+	const auto& record = packageLru.back();
+	dropPackage(*record.storage, record.storage->find(*record.packageName));
+}
+
+void CacheImpl::evictLeastRecentlyUsedSatisfyingVersions() const
+{
+	eraseSatisfyingVersions(getSatisfyingVersionsCache.find(*satisfyingVersionsLru.back()));
+}
+
+void CacheImpl::setMemoryLimit(size_t value)
+{
+	memoryLimit = value;
+}
+
+void CacheImpl::trimMemoryUsage() const
+{
+	while (memoryLimit && packagesSize + satisfyingVersionsSize > memoryLimit && !packageLru.empty())
+	{
+		evictLeastRecentlyUsedPackage();
+	}
+}
+
+Cache::MemoryUsage CacheImpl::getMemoryUsage() const
+{
+	Cache::MemoryUsage result;
+
+	result.prePackages = 0;
+	for (auto prePackages: { &preBinaryPackages, &preSourcePackages })
+	{
+		result.prePackages += memoryusage::ofHashTableSkeleton(*prePackages);
+		for (const auto& item: *prePackages)
+		{
+			result.prePackages += memoryusage::of(item.first) + memoryusage::ofVectorBuffer(item.second);
+		}
+	}
+
+	result.packages = 0;
+	for (auto packages: { &binaryPackages, &sourcePackages })
+	{
+		result.packages += memoryusage::ofHashTableSkeleton(*packages);
+		for (const auto& item: *packages)
+		{
+			result.packages += memoryusage::of(item.first) +
+					memoryusage::of(*item.second) + sizeof(*item.second);
+		}
+	}
+
+	result.provides = memoryusage::ofHashTableSkeleton(canProvide);
+	for (const auto& item: canProvide)
+	{
+		result.provides += memoryusage::of(item.first) + memoryusage::ofVectorBuffer(item.second);
+		for (const auto& record: item.second)
+		{
+			result.provides += memoryusage::of(record.providedVersionString);
+		}
+	}
+	result.provides += memoryusage::ofHashTableSkeleton(versionsByPrePackageRecord);
+	for (const auto& item: versionsByPrePackageRecord)
+	{
+		result.provides += memoryusage::ofVectorBuffer(item.second);
+	}
+
+	result.satisfyingVersions = memoryusage::ofHashTableSkeleton(getSatisfyingVersionsCache);
+	for (const auto& item: getSatisfyingVersionsCache)
+	{
+		result.satisfyingVersions += memoryusage::of(item.first) +
+				memoryusage::ofVectorBuffer(item.second.versions);
+	}
+	result.satisfyingVersions += memoryusage::ofHashTableSkeleton(satisfyingVersionsKeysByPackage);
+	for (const auto& item: satisfyingVersionsKeysByPackage)
+	{
+		result.satisfyingVersions += memoryusage::ofVectorBuffer(item.second);
+	}
+
+	result.translations = memoryusage::ofHashTableSkeleton(translations);
+	for (const auto& item: translations)
+	{
+		result.translations += memoryusage::of(item.first);
+	}
+
+	const size_t treeNodeOverhead = 4 * sizeof(void*); // color, parent and children
+	result.pins = pinCache.size() * (sizeof(decltype(pinCache)::value_type) + treeNodeOverhead);
+
+	return result;
+}
+
 static bool versionSatisfiesRelation(const BinaryVersion* version, const Relation& relation)
 {
 	if (relation.isSatisfiedBy(version->versionString))
@@ -166,56 +416,75 @@ void CacheImpl::addRealPackageSatisfyingVersions(vector<const BinaryVersion*>* r
 
 namespace {
 
-bool providesChunkMatchesRelation(const Relation& providesChunk, const Relation& relation)
+bool providedVersionMatchesRelation(const string& providedVersionString, const Relation& relation)
 {
-	if (providesChunk.packageName != relation.packageName)
-	{
-		return false;
-	}
 	if (relation.relationType == Relation::Types::None)
 	{
 		return true;
 	}
-	if (providesChunk.relationType != Relation::Types::Equal)
+	if (providedVersionString.empty())
 	{
 		return false;
 	}
-	return relation.isSatisfiedBy(providesChunk.versionString);
+	return relation.isSatisfiedBy(providedVersionString);
+}
+
 }
 
+// the providing package is parsed in full, since its versions are merged
+// from all its records; only the providers whose versioned Provides don't
+// match the relation are not parsed at all
+const BinaryVersion* CacheImpl::getVersionOfPrePackageRecord(const ReverseProvidesRecord& record) const
+{
+	auto package = getBinaryPackage(*record.packageName);
+	if (!package)
+	{
+		return nullptr;
+	}
+
+	const auto& recordVersions = versionsByPrePackageRecord.find(package)->second;
+	RecordVersion key { record.prePackageRecord, nullptr };
+	auto it = std::lower_bound(recordVersions.begin(), recordVersions.end(), key, isRecordVersionLess);
+	if (it != recordVersions.end() && !isRecordVersionLess(key, *it))
+	{
+		return it->version;
+	}
+	return nullptr;
 }
 
 void CacheImpl::addVirtualPackageSatisfyingVersions(vector<const BinaryVersion*>* result, const Relation& relation) const
 {
 	auto reverseProvidesIt = canProvide.find(relation.packageName);
-	if (reverseProvidesIt != canProvide.end())
+	if (reverseProvidesIt == canProvide.end())
+	{
+		return;
+	}
+
+	vector< const BinaryVersion* > providingVersions;
+	for (const auto& record: reverseProvidesIt->second)
 	{
-		for (const auto& it: reverseProvidesIt->second)
+		if (!providedVersionMatchesRelation(record.providedVersionString, relation))
 		{
-			auto reverseProvidePackage = getBinaryPackage(*it);
-			if (!reverseProvidePackage)
-			{
-				continue;
-			}
-			for (auto version: *reverseProvidePackage)
-			{
-				if (version->isInstalled() &&
-						systemState->getInstalledInfo(version->packageName)->isBroken())
-				{
-					continue;
-				}
-				for (const auto& providesChunk: version->provides)
-				{
-					if (providesChunkMatchesRelation(providesChunk, relation))
-					{
-						// ok, this particular version does provide this virtual package
-						result->push_back(version);
-						break;
-					}
-				}
-			}
+			continue;
+		}
+		auto version = getVersionOfPrePackageRecord(record);
+		if (!version)
+		{
+			continue;
 		}
+		if (version->isInstalled() &&
+				systemState->getInstalledInfo(version->packageName)->isBroken())
+		{
+			continue;
+		}
+		providingVersions.push_back(version);
 	}
+
+	// several records may be merged into the same version
+	std::sort(providingVersions.begin(), providingVersions.end());
+	providingVersions.erase(std::unique(providingVersions.begin(), providingVersions.end()),
+			providingVersions.end());
+	result->insert(result->end(), providingVersions.begin(), providingVersions.end());
 }
 
 static inline void sortByPackageNameAndVersion(vector<const BinaryVersion*>* result)
@@ -696,6 +965,17 @@ void CacheImpl::processTranslationFiles(const IndexEntry& indexEntry,
 	}
 }
 
+// the system state is parsed before the indexes, so its records go first
+bool CacheImpl::hasInstalledRecord(const string& packageName) const
+{
+	auto preIt = preBinaryPackages.find(packageName);
+	if (preIt == preBinaryPackages.end() || preIt->second.empty()) return false;
+
+	auto source = preIt->second.front().releaseInfoAndFile;
+	return std::find(installedReleaseInfoAndFiles.begin(), installedReleaseInfoAndFiles.end(), source) !=
+			installedReleaseInfoAndFiles.end();
+}
+
 void CacheImpl::processIndexFile(const string& path, IndexEntry::Type category,
 		shared_ptr< const ReleaseInfo > releaseInfo, const string& alias)
 {
@@ -711,16 +991,28 @@ void CacheImpl::processIndexFile(const string& path, IndexEntry::Type category,
 	try
 	{
 		string packageName;
-		const string* persistentPackageNamePtr;
+		string architecture;
+		const string* persistentPackageNamePtr = nullptr;
 
 		ioi::Record ioiRecord;
 		ioiRecord.offsetPtr = &prePackageRecord.offset;
 		ioiRecord.indexStringPtr = &packageName;
+		ioiRecord.architecturePtr = (category == IndexEntry::Binary) ? &architecture : nullptr;
 
 		ioi::ps::Callbacks callbacks;
 		callbacks.main =
-				[this, &packageName, &alias, &prePackagesStorage, &prePackageRecord, &persistentPackageNamePtr]()
+				[this, &packageName, &architecture, &alias, &prePackagesStorage, &prePackageRecord, &persistentPackageNamePtr]()
 				{
+					persistentPackageNamePtr = nullptr;
+
+					// versions of foreign architectures would be skipped while
+					// parsing anyway unless installed, no need to keep their records
+					if (!architecture.empty() && architecture != "all" && architecture != *binaryArchitecture &&
+							!hasInstalledRecord(packageName))
+					{
+						return;
+					}
+
 					try
 					{
 						checkPackageName(packageName);
@@ -738,9 +1030,12 @@ void CacheImpl::processIndexFile(const string& path, IndexEntry::Type category,
 							((const char*)(&prePackageRecords) - offsetof(PrePackageMap::value_type, second));
 				};
 		callbacks.provides =
-				[this, &persistentPackageNamePtr](const char* begin, const char* end)
+				[this, &persistentPackageNamePtr, &prePackageRecord](const char* begin, const char* end)
 				{
-					processProvides(persistentPackageNamePtr, begin, end);
+					if (persistentPackageNamePtr)
+					{
+						processProvides(persistentPackageNamePtr, prePackageRecord, begin, end);
+					}
 				};
 
 		ioi::ps::processIndex(path, callbacks, ioiRecord);
@@ -762,7 +1057,7 @@ void CacheImpl::processTranslationFile(const string& path, const string& alias)
 		TranslationPosition translationPosition;
 		translationPosition.file = file;
 
-		ioi::Record ioiRecord = { &translationPosition.offset, &md5 };
+		ioi::Record ioiRecord = { &translationPosition.offset, &md5, nullptr };
 
 		ioi::tr::Callbacks callbacks;
 		callbacks.main =
@@ -884,6 +1179,179 @@ void CacheImpl::parseExtendedStates()
 	}
 }
 
+// the records of parsed binary packages go back in the order of a freshly built cache
+void CacheImpl::restoreParsedPrePackageRecords()
+{
+	unordered_map< const void*, size_t > sourcePositions;
+	for (const auto& item: releaseInfoAndFileStorage)
+	{
+		sourcePositions.insert({ &item, sourcePositions.size() });
+	}
+	auto getSortKey = [&sourcePositions](const PrePackageRecord& record)
+	{
+		return std::make_pair(sourcePositions[record.releaseInfoAndFile], record.offset);
+	};
+
+	for (const auto& item: binaryPackages)
+	{
+		auto& records = preBinaryPackages.find(item.first)->second;
+		if (!records.empty()) continue;
+
+		for (const auto& recordVersion: versionsByPrePackageRecord.find(item.second.get())->second)
+		{
+			records.push_back(recordVersion.prePackageRecord);
+		}
+		std::sort(records.begin(), records.end(),
+				[&getSortKey](const PrePackageRecord& left, const PrePackageRecord& right)
+				{
+					return getSortKey(left) < getSortKey(right);
+				});
+	}
+}
+
+void CacheImpl::refreshSystemState()
+{
+	if (!memoryLimit)
+	{
+		restoreParsedPrePackageRecords();
+	}
+
+	auto oldSources = std::move(installedReleaseInfoAndFiles);
+	installedReleaseInfoAndFiles.clear();
+	auto isFromOldSources = [&oldSources](const PrePackageRecord& record)
+	{
+		return std::find(oldSources.begin(), oldSources.end(), record.releaseInfoAndFile) != oldSources.end();
+	};
+
+	auto readRecord = [](const PrePackageRecord& record) -> string
+	{
+		const auto& file = record.releaseInfoAndFile->second;
+		file->seek(record.offset);
+		return file->getRecord();
+	};
+
+	std::set< const string* > affectedPackageNames;
+	// parsed packages are kept if their installed records stay the same
+	unordered_map< const string*, string > oldInstalledRecords;
+	for (auto& item: preBinaryPackages)
+	{
+		auto& records = item.second;
+		if (binaryPackages.count(item.first))
+		{
+			for (const auto& record: records)
+			{
+				if (isFromOldSources(record))
+				{
+					oldInstalledRecords[&item.first] = readRecord(record);
+				}
+			}
+		}
+		auto newEnd = std::remove_if(records.begin(), records.end(), isFromOldSources);
+		if (newEnd != records.end())
+		{
+			records.erase(newEnd, records.end());
+			affectedPackageNames.insert(&item.first);
+		}
+	}
+
+	for (auto& item: canProvide)
+	{
+		auto& records = item.second;
+		records.erase(std::remove_if(records.begin(), records.end(),
+				[&isFromOldSources](const ReverseProvidesRecord& record)
+				{
+					return isFromOldSources(record.prePackageRecord);
+				}),
+				records.end());
+	}
+
+	auto releaseDataPosition = binaryReleaseData.end();
+	vector< shared_ptr< const ReleaseInfo > > oldReleaseInfos;
+	for (auto source: oldSources)
+	{
+		oldReleaseInfos.push_back(source->first);
+		releaseDataPosition = binaryReleaseData.erase(
+				std::find(binaryReleaseData.begin(), binaryReleaseData.end(), source->first));
+		releaseInfoAndFileStorage.remove_if([source](decltype(*source) item) { return &item == source; });
+	}
+
+	systemState.reset(new system::State(config, this));
+	// keeping the release data order as in a freshly built cache
+	auto newSourceCount = installedReleaseInfoAndFiles.size();
+	std::rotate(releaseDataPosition, binaryReleaseData.end() - newSourceCount, binaryReleaseData.end());
+
+	const auto& newSources = installedReleaseInfoAndFiles;
+	// the versions of the kept packages point to the old release info, which
+	// is equal to the new one of the same archive
+	for (auto& item: releaseInfoAndFileStorage)
+	{
+		if (std::find(newSources.begin(), newSources.end(), &item) == newSources.end()) continue;
+
+		for (const auto& oldReleaseInfo: oldReleaseInfos)
+		{
+			if (oldReleaseInfo->archive == item.first->archive)
+			{
+				std::replace(binaryReleaseData.begin(), binaryReleaseData.end(), item.first, oldReleaseInfo);
+				item.first = oldReleaseInfo;
+			}
+		}
+	}
+	auto isFromNewSources = [&newSources](const PrePackageRecord& record)
+	{
+		return std::find(newSources.begin(), newSources.end(), record.releaseInfoAndFile) != newSources.end();
+	};
+	for (const auto& packageName: systemState->getInstalledPackageNames())
+	{
+		auto preIt = preBinaryPackages.find(packageName);
+		// installed records are expected to go first, as in a freshly built cache
+		auto& records = preIt->second;
+		std::stable_partition(records.begin(), records.end(), isFromNewSources);
+
+		auto oldRecordIt = oldInstalledRecords.find(&preIt->first);
+		if (oldRecordIt != oldInstalledRecords.end() && oldRecordIt->second == readRecord(records.front()))
+		{
+			affectedPackageNames.erase(&preIt->first);
+		}
+		else
+		{
+			affectedPackageNames.insert(&preIt->first);
+		}
+	}
+
+	std::set< const string* > vanishedPackageNames;
+	for (auto packageNamePtr: affectedPackageNames)
+	{
+		auto packageIt = binaryPackages.find(*packageNamePtr);
+		if (packageIt != binaryPackages.end())
+		{
+			dropPackage(binaryPackages, packageIt);
+		}
+		if (preBinaryPackages.find(*packageNamePtr)->second.empty())
+		{
+			vanishedPackageNames.insert(packageNamePtr);
+		}
+	}
+	for (auto packageNamePtr: vanishedPackageNames)
+	{
+		preBinaryPackages.erase(preBinaryPackages.find(*packageNamePtr));
+	}
+
+	if (!memoryLimit)
+	{
+		for (const auto& item: binaryPackages)
+		{
+			vector< PrePackageRecord >().swap(preBinaryPackages.find(item.first)->second);
+		}
+	}
+
+	pinCache.clear();
+	dropSatisfyingVersionsCache();
+	parsePreferences();
+
+	extendedInfo = ExtendedInfo();
+	parseExtendedStates();
+}
+
 void CacheImpl::p_parseExtendedStatesContent(File& contentFile)
 {
 	internal::TagParser parser(&contentFile);
@@ -954,12 +1422,25 @@ CacheImpl::getSatisfyingVersions(const RelationExpression& relationExpression) c
 		auto it = getSatisfyingVersionsCache.find(key);
 		if (it != getSatisfyingVersionsCache.end())
 		{
-			return it->second;
+			if (memoryLimit)
+			{
+				satisfyingVersionsLru.splice(satisfyingVersionsLru.begin(),
+						satisfyingVersionsLru, it->second.lruPosition);
+			}
+			return it->second.versions;
 		}
 		else
 		{
-			auto& result = getSatisfyingVersionsCache[std::move(key)];
-			result = getSatisfyingVersionsNonCached(relationExpression);
+			auto result = getSatisfyingVersionsNonCached(relationExpression);
+			it = getSatisfyingVersionsCache.insert({ std::move(key), { result, {}, 0 } }).first;
+			if (memoryLimit)
+			{
+				addSatisfyingVersionsToLru(it);
+				while (packagesSize + satisfyingVersionsSize > memoryLimit && satisfyingVersionsLru.size() > 1)
+				{
+					evictLeastRecentlyUsedSatisfyingVersions();
+				}
+			}
 			return result;
 		}
 	}
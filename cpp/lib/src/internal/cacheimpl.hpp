@@ -59,37 +59,87 @@ class CacheImpl
 		File* file;
 		uint32_t offset;
 	};
+	typedef unordered_map< string, unique_ptr< Package > > PackageMap;
+	struct PackageLruRecord
+	{
+		PackageMap* storage;
+		const string* packageName;
+		size_t size;
+	};
+	struct SatisfyingVersionsCacheEntry
+	{
+		vector< const BinaryVersion* > versions;
+		list< const string* >::iterator lruPosition;
+		size_t size;
+	};
+	typedef unordered_map< string, SatisfyingVersionsCacheEntry > SatisfyingVersionsCache;
+
+	struct ReverseProvidesRecord
+	{
+		const string* packageName;
+		PrePackageRecord prePackageRecord;
+		string providedVersionString; // empty if no '=' version is provided
+	};
+
+	struct RecordVersion
+	{
+		PrePackageRecord prePackageRecord;
+		const BinaryVersion* version;
+	};
 
-	unordered_map< string, vector< const string* > > canProvide;
-	mutable unordered_map< string, unique_ptr< Package > > binaryPackages;
-	mutable unordered_map< string, unique_ptr< Package > > sourcePackages;
+	unordered_map< string, vector< ReverseProvidesRecord > > canProvide;
+	// sorted by the record, see CacheImpl::getVersionOfPrePackageRecord
+	mutable unordered_map< const Package*, vector< RecordVersion > > versionsByPrePackageRecord;
+	mutable PackageMap binaryPackages;
+	mutable PackageMap sourcePackages;
 	unordered_map< string, TranslationPosition > translations;
-	mutable unordered_map< string, vector< const BinaryVersion* > > getSatisfyingVersionsCache;
+	mutable SatisfyingVersionsCache getSatisfyingVersionsCache;
 	shared_ptr< PinInfo > pinInfo;
 	mutable map< const Version*, ssize_t > pinCache;
-	map< string, shared_ptr< ReleaseInfo > > releaseInfoCache;
+	map< string, shared_ptr< const ReleaseInfo > > releaseInfoCache;
 	list< RequiredFile > translationFileStorage;
 	smatch* __smatch_ptr;
 
+	// bounded mode, used only if memoryLimit is non-zero
+	size_t memoryLimit;
+	mutable list< PackageLruRecord > packageLru;
+	mutable unordered_map< const Package*, list< PackageLruRecord >::iterator > packageLruPositions;
+	mutable size_t packagesSize;
+	mutable list< const string* > satisfyingVersionsLru;
+	// the keys of memoized satisfying versions by the packages of their versions
+	mutable unordered_map< const Package*, vector< const string* > > satisfyingVersionsKeysByPackage;
+	mutable size_t satisfyingVersionsSize;
+
+	static bool isRecordVersionLess(const RecordVersion&, const RecordVersion&);
 	Package* newSourcePackage() const;
 	Package* newBinaryPackage() const;
 	Package* preparePackage(unordered_map< string, vector< PrePackageRecord > >&,
-			unordered_map< string, unique_ptr< Package > >&, const string&,
-			decltype(&CacheImpl::newBinaryPackage)) const;
+			PackageMap&, const string&, decltype(&CacheImpl::newBinaryPackage)) const;
+	void touchPackage(PackageMap&, const string&, const Package*) const;
+	void dropPackage(PackageMap&, PackageMap::iterator) const;
+	void dropSatisfyingVersionsCache() const;
+	vector< const Package* > getPackagesOfVersions(const vector< const BinaryVersion* >&) const;
+	void addSatisfyingVersionsToLru(SatisfyingVersionsCache::iterator) const;
+	void eraseSatisfyingVersions(SatisfyingVersionsCache::iterator) const;
+	void evictLeastRecentlyUsedPackage() const;
+	void evictLeastRecentlyUsedSatisfyingVersions() const;
 	shared_ptr< ReleaseInfo > getReleaseInfo(const Config&, const IndexEntry&);
 	void parseSourceList(const string& path);
 	void processIndexEntry(const IndexEntry&, const ReleaseLimits&);
 	void processIndexFile(const string& path, IndexEntry::Type category,
 			shared_ptr< const ReleaseInfo >, const string&);
+	bool hasInstalledRecord(const string& packageName) const;
 	void processTranslationFiles(const IndexEntry&, const string&);
 	void processTranslationFile(const string& path, const string&);
 	void p_parseExtendedStatesContent(File& content);
+	void restoreParsedPrePackageRecords();
 
 	void addRealPackageSatisfyingVersions(vector<const BinaryVersion*>*, const Relation&) const;
 	void addVirtualPackageSatisfyingVersions(vector<const BinaryVersion*>*, const Relation&) const;
 	vector< const BinaryVersion* > getSatisfyingVersionsNonCached(const Relation&) const;
 	vector< const BinaryVersion* > getSatisfyingVersionsNonCached(const RelationExpression&) const;
 
+	const BinaryVersion* getVersionOfPrePackageRecord(const ReverseProvidesRecord&) const;
 	ssize_t computePin(const Version*, const BinaryPackage*) const;
  public:
 	shared_ptr< const Config > config;
@@ -102,20 +152,26 @@ class CacheImpl
 	mutable PrePackageMap preBinaryPackages;
 	list< pair< shared_ptr< const ReleaseInfo >, shared_ptr< File > > >
 			releaseInfoAndFileStorage;
+	vector< const pair< shared_ptr< const ReleaseInfo >, shared_ptr< File > >* >
+			installedReleaseInfoAndFiles;
 	ExtendedInfo extendedInfo;
 
 	CacheImpl();
 	~CacheImpl();
+	void setMemoryLimit(size_t);
 	void parseSourcesLists();
 	void processIndexEntries(bool, bool);
 	void parsePreferences();
 	void parseExtendedStates();
+	void refreshSystemState();
 	const BinaryPackage* getBinaryPackage(const string& packageName) const;
 	const SourcePackage* getSourcePackage(const string& packageName) const;
 	ssize_t getPin(const Version*, const std::function< const BinaryPackage* () >&) const;
 	string getLocalizedDescription(const BinaryVersion*) const;
-	void processProvides(const string*, const char*, const char*);
+	void processProvides(const string*, const PrePackageRecord&, const char*, const char*);
 	vector< const BinaryVersion* > getSatisfyingVersions(const RelationExpression&) const;
+	Cache::MemoryUsage getMemoryUsage() const;
+	void trimMemoryUsage() const;
 };
 
 }
@@ -46,6 +46,7 @@ void parsePackagesSourcesFullIndex(const string& path, const ps::Callbacks& call
 	RequiredFile file(path, "r");
 
 	uint32_t offset = 0;
+	vector< string > providesStrings;
 
 	while (true)
 	{
@@ -73,16 +74,34 @@ void parsePackagesSourcesFullIndex(const string& path, const ps::Callbacks& call
 		{
 			fatal2(__("unable to find a Package line"));
 		}
-		callbacks.main();
+		if (record.architecturePtr)
+		{
+			record.architecturePtr->clear();
+		}
 
+		// the architecture has to be known before the main callback, so
+		// the provides are reported only after the whole record is read
+		providesStrings.clear();
 		while (getNextLine(), size > 1)
 		{
 			static const size_t providesAnchorLength = sizeof("Provides: ") - 1;
+			static const size_t architectureAnchorLength = sizeof("Architecture: ") - 1;
 			if (*buf == 'P' && size > providesAnchorLength && !memcmp("rovides: ", buf+1, providesAnchorLength-1))
 			{
-				callbacks.provides(buf + providesAnchorLength, buf + size - 1);
+				providesStrings.emplace_back(buf + providesAnchorLength, buf + size - 1);
+			}
+			else if (*buf == 'A' && record.architecturePtr && size > architectureAnchorLength &&
+					!memcmp("rchitecture: ", buf+1, architectureAnchorLength-1))
+			{
+				record.architecturePtr->assign(buf + architectureAnchorLength, buf + size - 1);
 			}
 		}
+
+		callbacks.main();
+		for (const auto& providesString: providesStrings)
+		{
+			callbacks.provides(providesString.data(), providesString.data() + providesString.size());
+		}
 	}
 }
 
@@ -185,16 +204,34 @@ void templatedParseIndexOfIndex(const string& path, const Callbacks& callbacks,
 			{
 				fatal2i("ioi: offset and index string: too small line");
 			}
-			// finding delimiter (format: "<hex>\0<packagename>\n)
-			auto delimiterPosition = memchr(buf+1, '\0', bufSize-3);
+			// finding delimiter (format: "<hex>\0<packagename>[\0<architecture>]\n)
+			auto delimiterPosition = (const char*)memchr(buf+1, '\0', bufSize-3);
 			if (!delimiterPosition)
 			{
 				fatal2i("ioi: offset and index string: no delimiter found");
 			}
+			auto indexStringEnd = buf+bufSize-1;
+			auto architectureDelimiterPosition = (const char*)memchr(
+					delimiterPosition+1, '\0', indexStringEnd - (delimiterPosition+1));
 
 			absoluteOffset += ourHex2Uint(buf);
 			(*record.offsetPtr) = absoluteOffset;
-			record.indexStringPtr->assign((const char*)delimiterPosition+1, buf+bufSize-1);
+			if (architectureDelimiterPosition)
+			{
+				record.indexStringPtr->assign(delimiterPosition+1, architectureDelimiterPosition);
+				if (record.architecturePtr)
+				{
+					record.architecturePtr->assign(architectureDelimiterPosition+1, indexStringEnd);
+				}
+			}
+			else
+			{
+				record.indexStringPtr->assign(delimiterPosition+1, indexStringEnd);
+				if (record.architecturePtr)
+				{
+					record.architecturePtr->clear();
+				}
+			}
 			callbacks.main();
 		}
 		while (file.rawGetLine(buf, bufSize), bufSize > 1)
@@ -230,7 +267,7 @@ void parseTranslationIndexOfIndex(const string& path, const tr::Callbacks& callb
 	templatedParseIndexOfIndex(path, callbacks, record, additionalLinesParser);
 }
 
-static const string indexPathSuffix = ".index" "0";
+static const string indexPathSuffix = ".index" "1";
 
 void putUint2Hex(File& file, uint32_t value)
 {
@@ -242,6 +279,7 @@ void putUint2Hex(File& file, uint32_t value)
 struct MainCallback
 {
 	string indexString;
+	string architecture;
 	uint32_t previousOffset;
 	uint32_t offset;
 	bool isFirstRecord;
@@ -260,6 +298,11 @@ struct MainCallback
 		putUint2Hex(file, relativeOffset);
 		file.put("\0", 1);
 		file.put(indexString);
+		if (!architecture.empty())
+		{
+			file.put("\0", 1);
+			file.put(architecture);
+		}
 		file.put("\n");
 
 		previousOffset = offset;
@@ -277,7 +320,7 @@ void templatedGenerate(const string& indexPath, const string& temporaryPath,
 	callbacks.main = std::bind(&MainCallback::perform, std::ref(mainCallback), std::ref(file));
 
 	fullIndexParser(indexPath, callbacks,
-			{ &mainCallback.offset, &mainCallback.indexString });
+			{ &mainCallback.offset, &mainCallback.indexString, &mainCallback.architecture });
 
 	fs::move(temporaryPath, getIndexOfIndexPath(indexPath));
 }
@@ -24,6 +24,7 @@ struct Record
 {
 	uint32_t* offsetPtr;
 	string* indexStringPtr;
+	string* architecturePtr; // optional, empty if the record has no architecture
 };
 // index suffix number must be incremented every time Record changes
 
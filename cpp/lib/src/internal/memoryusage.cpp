@@ -0,0 +1,163 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cupt/cache/package.hpp>
+#include <cupt/cache/binaryversion.hpp>
+#include <cupt/cache/sourceversion.hpp>
+#include <cupt/cache/relation.hpp>
+
+#include <internal/memoryusage.hpp>
+
+namespace cupt {
+namespace internal {
+namespace memoryusage {
+
+using namespace cache;
+
+// libstdc++ keeps up to 15 characters inside the string object itself
+static const size_t shortStringCapacity = 15;
+
+static size_t of(const Relation&);
+static size_t of(const RelationExpression&);
+static size_t of(const ArchitecturedRelation&);
+static size_t of(const ArchitecturedRelationExpression&);
+static size_t of(const Version::FileRecord&);
+
+template < typename ContainerT >
+static size_t ofElements(const ContainerT& container)
+{
+	size_t result = ofVectorBuffer(container);
+	for (const auto& element: container)
+	{
+		result += of(element);
+	}
+	return result;
+}
+
+size_t of(const Relation& relation)
+{
+	return of(relation.packageName) + of(relation.architecture) + of(relation.versionString);
+}
+
+size_t of(const RelationExpression& relationExpression)
+{
+	return ofElements(relationExpression);
+}
+
+size_t of(const ArchitecturedRelation& relation)
+{
+	size_t result = of(static_cast< const Relation& >(relation)) + ofElements(relation.architectureFilters);
+	result += ofVectorBuffer(relation.buildProfiles);
+	for (const auto& profileGroup: relation.buildProfiles)
+	{
+		result += ofElements(profileGroup);
+	}
+	return result;
+}
+
+size_t of(const ArchitecturedRelationExpression& relationExpression)
+{
+	return ofElements(relationExpression);
+}
+
+size_t of(const Version::FileRecord& fileRecord)
+{
+	size_t result = of(fileRecord.name);
+	for (const auto& hashSum: fileRecord.hashSums.values)
+	{
+		result += of(hashSum);
+	}
+	return result;
+}
+
+static size_t ofCommonPart(const Version& version)
+{
+	size_t result = ofVectorBuffer(version.sources);
+	for (const auto& source: version.sources)
+	{
+		result += of(source.directory);
+	}
+	result += of(version.packageName) + of(version.section) +
+			of(version.maintainer) + of(version.versionString);
+	if (version.others)
+	{
+		for (const auto& item: *version.others)
+		{
+			result += of(item.first) + of(item.second) + sizeof(item) + 4 * sizeof(void*);
+		}
+	}
+	return result;
+}
+
+static size_t of(const BinaryVersion& version)
+{
+	size_t result = sizeof(version) + ofCommonPart(version);
+	result += of(version.architecture) + of(version.sourcePackageName) +
+			of(version.sourceVersionString) + of(version.multiarch) +
+			of(version.description) + of(version.descriptionHash) +
+			of(version.tags) + of(version.file);
+	for (const auto& relationLine: version.relations)
+	{
+		result += ofElements(relationLine);
+	}
+	result += ofElements(version.provides);
+	return result;
+}
+
+static size_t of(const SourceVersion& version)
+{
+	size_t result = sizeof(version) + ofCommonPart(version);
+	for (const auto& relationLine: version.relations)
+	{
+		result += ofElements(relationLine);
+	}
+	for (const auto& fileRecords: version.files)
+	{
+		result += ofElements(fileRecords);
+	}
+	result += ofElements(version.uploaders) + ofElements(version.binaryPackageNames) +
+			ofElements(version.architectures);
+	return result;
+}
+
+size_t of(const string& s)
+{
+	return (s.capacity() > shortStringCapacity) ? s.capacity() + 1 : 0;
+}
+
+size_t of(const Package& package)
+{
+	size_t result = 0;
+	for (auto version: package)
+	{
+		result += sizeof(unique_ptr< Version >);
+		if (auto binaryVersion = dynamic_cast< const BinaryVersion* >(version))
+		{
+			result += of(*binaryVersion);
+		}
+		else if (auto sourceVersion = dynamic_cast< const SourceVersion* >(version))
+		{
+			result += of(*sourceVersion);
+		}
+	}
+	return result;
+}
+
+}
+}
+}
+
@@ -0,0 +1,55 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_MEMORYUSAGE_SEEN
+#define CUPT_INTERNAL_MEMORYUSAGE_SEEN
+
+#include <unordered_map>
+
+#include <cupt/common.hpp>
+#include <cupt/fwd.hpp>
+
+namespace cupt {
+namespace internal {
+namespace memoryusage {
+
+// all functions return approximate heap sizes in bytes, not including sizeof() of
+// the argument itself
+
+size_t of(const string&);
+size_t of(const cache::Package&);
+
+template < typename T >
+size_t ofVectorBuffer(const vector< T >& v)
+{
+	return v.capacity() * sizeof(T);
+}
+
+template < typename KeyT, typename ValueT >
+size_t ofHashTableSkeleton(const std::unordered_map< KeyT, ValueT >& m)
+{
+	const size_t nodeOverhead = 2 * sizeof(void*); // next pointer and the cached hash
+	return m.bucket_count() * sizeof(void*) +
+			m.size() * (sizeof(typename std::unordered_map< KeyT, ValueT >::value_type) + nodeOverhead);
+}
+
+}
+}
+}
+
+#endif
+
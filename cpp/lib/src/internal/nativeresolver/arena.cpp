@@ -0,0 +1,90 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <internal/nativeresolver/arena.hpp>
+
+namespace cupt {
+namespace internal {
+
+Arena::Arena()
+	: p_shared(false), p_chunkPosition(nullptr), p_chunkRemainingSize(0)
+{
+	std::fill(std::begin(p_freeLists), std::end(p_freeLists), nullptr);
+}
+
+Arena::~Arena()
+{}
+
+size_t Arena::p_getSizeClass(size_t size)
+{
+	return (size + p_granularity - 1) / p_granularity;
+}
+
+void Arena::setShared(bool value)
+{
+	p_shared = value;
+}
+
+void* Arena::allocate(size_t size)
+{
+	auto sizeClass = p_getSizeClass(size);
+
+	std::unique_lock< std::mutex > lock(p_mutex, std::defer_lock);
+	if (p_shared) lock.lock();
+
+	auto& freeList = p_freeLists[sizeClass-1];
+	if (freeList)
+	{
+		auto result = freeList;
+		freeList = freeList->next;
+		return result;
+	}
+
+	auto blockSize = sizeClass * p_granularity;
+	if (p_chunkRemainingSize < blockSize)
+	{
+		// the rest of the current chunk, if any, is wasted
+		p_chunks.emplace_back(new char[p_chunkSize]);
+		p_chunkPosition = p_chunks.back().get();
+		p_chunkRemainingSize = p_chunkSize;
+	}
+	auto result = p_chunkPosition;
+	p_chunkPosition += blockSize;
+	p_chunkRemainingSize -= blockSize;
+	return result;
+}
+
+void Arena::deallocate(void* block, size_t size)
+{
+	auto freeBlock = static_cast< FreeBlock* >(block);
+
+	std::unique_lock< std::mutex > lock(p_mutex, std::defer_lock);
+	if (p_shared) lock.lock();
+
+	auto& freeList = p_freeLists[p_getSizeClass(size)-1];
+	freeBlock->next = freeList;
+	freeList = freeBlock;
+}
+
+size_t Arena::getAllocatedSize() const
+{
+	return p_chunks.size() * p_chunkSize;
+}
+
+}
+}
+
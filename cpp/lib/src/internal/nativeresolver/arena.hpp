@@ -0,0 +1,128 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_NATIVERESOLVER_ARENA_SEEN
+#define CUPT_INTERNAL_NATIVERESOLVER_ARENA_SEEN
+
+#include <cstddef>
+#include <mutex>
+
+namespace cupt {
+namespace internal {
+
+// allocates small blocks from big chunks and keeps freed blocks for reuse;
+// the chunks are returned to the system only when the arena is destroyed
+class Arena
+{
+ public:
+	static const size_t maxBlockSize = 256;
+ private:
+	static const size_t p_granularity = alignof(std::max_align_t);
+	static const size_t p_chunkSize = 64*1024;
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	bool p_shared;
+	std::mutex p_mutex; // taken only while the arena is shared
+	vector< unique_ptr< char[] > > p_chunks;
+	char* p_chunkPosition;
+	size_t p_chunkRemainingSize;
+	FreeBlock* p_freeLists[maxBlockSize / p_granularity];
+
+	static size_t p_getSizeClass(size_t);
+
+	Arena(const Arena&) = delete;
+ public:
+	Arena();
+	~Arena();
+
+	// a shared arena may be used from several threads at once; the switch
+	// itself must be synchronized with all the users by the caller
+	void setShared(bool);
+
+	void* allocate(size_t);
+	void deallocate(void*, size_t);
+
+	size_t getAllocatedSize() const;
+};
+
+template < typename T >
+class ArenaAllocator
+{
+	template < typename U >
+	friend class ArenaAllocator;
+
+	Arena* p_arena;
+ public:
+	typedef T value_type;
+
+	ArenaAllocator(Arena& arena)
+		: p_arena(&arena)
+	{}
+	template < typename U >
+	ArenaAllocator(const ArenaAllocator< U >& other)
+		: p_arena(other.p_arena)
+	{}
+
+	T* allocate(size_t n)
+	{
+		size_t size = n * sizeof(T);
+		if (size > Arena::maxBlockSize)
+		{
+			return static_cast< T* >(::operator new(size));
+		}
+		return static_cast< T* >(p_arena->allocate(size));
+	}
+	void deallocate(T* p, size_t n)
+	{
+		size_t size = n * sizeof(T);
+		if (size > Arena::maxBlockSize)
+		{
+			::operator delete(p);
+		}
+		else
+		{
+			p_arena->deallocate(p, size);
+		}
+	}
+
+	template < typename U >
+	bool operator==(const ArenaAllocator< U >& other) const
+	{
+		return p_arena == other.p_arena;
+	}
+	template < typename U >
+	bool operator!=(const ArenaAllocator< U >& other) const
+	{
+		return p_arena != other.p_arena;
+	}
+};
+
+template < typename T, typename... Args >
+shared_ptr< T > allocateShared(Arena& arena, Args&&... args)
+{
+	return std::allocate_shared< T >(ArenaAllocator< T >(arena), std::forward< Args >(args)...);
+}
+
+}
+}
+
+#endif
+
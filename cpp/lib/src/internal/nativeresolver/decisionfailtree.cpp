@@ -22,7 +22,7 @@
 namespace cupt {
 namespace internal {
 
-string DecisionFailTree::__decisions_to_string(
+string DecisionFailTree::__decisions_to_string(const SolutionStorage& solutionStorage,
 		const vector< Decision >& decisions)
 {
 	auto insertedElementPtrToString = [](dg::Element element) -> string
@@ -31,7 +31,7 @@ string DecisionFailTree::__decisions_to_string(
 		{
 			return __("no solutions"); // root
 		}
-		auto versionElement = dynamic_cast<dg::VersionElement>(element);
+		auto versionElement = element->asVersion();
 		if (!versionElement)
 		{
 			fatal2i("__fail_leaf_to_string: '%s' is not a version element",
@@ -44,7 +44,7 @@ string DecisionFailTree::__decisions_to_string(
 	FORIT(it, decisions)
 	{
 		result.append(it->level * 2, ' ');
-		result.append(it->introducedBy.getReason()->toString());
+		result.append(solutionStorage.getReason(it->introducedBy)->toString());
 		result.append(" -> ");
 		result.append(insertedElementPtrToString(it->insertedElementPtr));
 		result.append("\n");
@@ -52,12 +52,12 @@ string DecisionFailTree::__decisions_to_string(
 	return result;
 }
 
-string DecisionFailTree::toString() const
+string DecisionFailTree::toString(const SolutionStorage& solutionStorage) const
 {
 	string result;
 	FORIT(childIt, __fail_items)
 	{
-		result += __decisions_to_string(childIt->decisions);
+		result += __decisions_to_string(solutionStorage, childIt->decisions);
 		result += "\n";
 	}
 	return result;
@@ -93,7 +93,7 @@ vector< DecisionFailTree::Decision > DecisionFailTree::__get_decisions(
 				item.introducedBy, item.insertedElementPtr, std::cref(queueItem));
 	}
 
-	return std::move(result);
+	return result;
 }
 
 // fail item is dominant if a diversed element didn't cause final breakage
@@ -43,12 +43,12 @@ class DecisionFailTree
 	};
 	std::list< FailItem > __fail_items;
 
-	static string __decisions_to_string(const vector< Decision >&);
+	static string __decisions_to_string(const SolutionStorage&, const vector< Decision >&);
 	static vector< Decision > __get_decisions(
 			const SolutionStorage& solutionStorage, const PreparedSolution& solution, const IntroducedBy&);
 	static bool __is_dominant(const FailItem&, dg::Element);
  public:
-	string toString() const;
+	string toString(const SolutionStorage&) const;
 	void addFailedSolution(const SolutionStorage&, const PreparedSolution&, const IntroducedBy&);
 	void clear();
 };
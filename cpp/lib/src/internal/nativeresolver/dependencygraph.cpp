@@ -29,6 +29,7 @@ using std::list;
 
 #include <internal/nativeresolver/solution.hpp>
 #include <internal/nativeresolver/dependencygraph.hpp>
+#include <internal/nativeresolver/graphcache.hpp>
 
 namespace std {
 
@@ -58,22 +59,30 @@ using std::make_pair;
 BasicVertex::~BasicVertex()
 {}
 
-size_t BasicVertex::getTypePriority() const
-{
-	fatal2i("getting priority of '%s'", toString());
-	return VertexTypePriority::Zero; // unreachable
-}
-
 uint32_t BasicVertex::__next_id = 0;
 
-BasicVertex::BasicVertex()
-	: id(__next_id++)
+BasicVertex::BasicVertex(bool isVersion)
+	: p_familyKey(nullptr), p_relatedElements(nullptr)
+	, p_typePriority(VertexTypePriority::Zero), p_isAnti(false)
+	, p_isVersion(isVersion), id(__next_id++)
 {}
 
-bool BasicVertex::isAnti() const
+void BasicVertex::p_fixProperties()
+{
+	p_familyKey = computeFamilyKey();
+	p_relatedElements = computeRelatedElements();
+	p_typePriority = computeTypePriority();
+	p_isAnti = computeIsAnti();
+}
+
+size_t BasicVertex::computeTypePriority() const
 {
-	fatal2i("getting isAnti of '%s'", toString());
-	return false; // unreachable
+	return VertexTypePriority::Zero;
+}
+
+bool BasicVertex::computeIsAnti() const
+{
+	return false;
 }
 
 shared_ptr< const Reason > BasicVertex::getReason(const BasicVertex&) const
@@ -82,10 +91,9 @@ shared_ptr< const Reason > BasicVertex::getReason(const BasicVertex&) const
 	return shared_ptr< const Reason >(); // unreachable
 }
 
-const vector<Element>* BasicVertex::getRelatedElements() const
+const vector<Element>* BasicVertex::computeRelatedElements() const
 {
-	fatal2i("getting related elements of '%s'", toString());
-	return NULL; // unreachable
+	return NULL;
 }
 
 Unsatisfied::Type BasicVertex::getUnsatisfiedType() const
@@ -105,7 +113,7 @@ bool BasicVertex::asAuto() const
 	return true; // unreacahble
 }
 
-Element BasicVertex::getFamilyKey() const
+Element BasicVertex::computeFamilyKey() const
 {
 	return this;
 }
@@ -122,7 +130,7 @@ struct ExtendedBasicVertex: public BasicVertex
 
 
 VersionVertex::VersionVertex(const FamilyMap::iterator& it)
-	: __related_element_ptrs_it(it)
+	: BasicVertex(true), __related_element_ptrs_it(it)
 {}
 
 string VersionVertex::toString() const
@@ -131,7 +139,7 @@ string VersionVertex::toString() const
 			(version ? version->versionString : "<not installed>");
 }
 
-const vector<Element>* VersionVertex::getRelatedElements() const
+const vector<Element>* VersionVertex::computeRelatedElements() const
 {
 	return &__related_element_ptrs_it->second;
 }
@@ -154,7 +162,7 @@ string VersionVertex::toLocalizedString() const
 	}
 }
 
-Element VersionVertex::getFamilyKey() const
+Element VersionVertex::computeFamilyKey() const
 {
 	return __related_element_ptrs_it->second.front();
 }
@@ -167,9 +175,9 @@ struct RelationExpressionVertex: public ExtendedBasicVertex
 	const RelationExpression* relationExpressionPtr;
 
 	string toString() const;
-	size_t getTypePriority() const;
+	size_t computeTypePriority() const;
 	shared_ptr< const Reason > getReason(const BasicVertex& parent) const;
-	bool isAnti() const;
+	bool computeIsAnti() const;
 	Unsatisfied::Type getUnsatisfiedType() const;
 	bool asAuto() const
 	{
@@ -183,7 +191,7 @@ string RelationExpressionVertex::toString() const
 			relationExpressionPtr->toString());
 }
 
-size_t RelationExpressionVertex::getTypePriority() const
+size_t RelationExpressionVertex::computeTypePriority() const
 {
 	switch (dependencyType)
 	{
@@ -200,7 +208,7 @@ size_t RelationExpressionVertex::getTypePriority() const
 	return VertexTypePriority::Zero; // unreacahble
 }
 
-bool RelationExpressionVertex::isAnti() const
+bool RelationExpressionVertex::computeIsAnti() const
 {
 	return false;
 }
@@ -209,7 +217,7 @@ shared_ptr< const Reason > RelationExpressionVertex::getReason(const BasicVertex
 {
 	typedef system::Resolver::RelationExpressionReason OurReason;
 
-	auto versionParent = dynamic_cast< const VersionVertex* >(&parent);
+	auto versionParent = parent.asVersion();
 	if (!versionParent)
 	{
 		fatal2i("a parent of relation expression vertex is not a version vertex");
@@ -240,11 +248,11 @@ struct AntiRelationExpressionVertex: public RelationExpressionVertex
 	{
 		return RelationExpressionVertex::toString() + " [" + specificPackageName + ']';
 	}
-	size_t getTypePriority() const
+	size_t computeTypePriority() const
 	{
 		return VertexTypePriority::StrongRelationExpression;
 	}
-	bool isAnti() const
+	bool computeIsAnti() const
 	{
 		return true;
 	}
@@ -265,9 +273,9 @@ struct SynchronizeVertex: public BasicVertex
 
 	SynchronizeVertex(bool isHard);
 	string toString() const;
-	size_t getTypePriority() const;
+	size_t computeTypePriority() const;
 	shared_ptr< const Reason > getReason(const BasicVertex& parent) const;
-	bool isAnti() const;
+	bool computeIsAnti() const;
 	Unsatisfied::Type getUnsatisfiedType() const;
 };
 
@@ -280,14 +288,14 @@ string SynchronizeVertex::toString() const
 	return string("sync with ") + targetPackageName;
 }
 
-size_t SynchronizeVertex::getTypePriority() const
+size_t SynchronizeVertex::computeTypePriority() const
 {
 	return isHard ? VertexTypePriority::StrongRelationExpression : VertexTypePriority::WishRequest;
 }
 
 shared_ptr< const Reason > SynchronizeVertex::getReason(const BasicVertex& parent) const
 {
-	auto versionParent = dynamic_cast< const VersionVertex* >(&parent);
+	auto versionParent = parent.asVersion();
 	if (!versionParent)
 	{
 		fatal2i("a parent of synchronize vertex is not a version vertex");
@@ -296,7 +304,7 @@ shared_ptr< const Reason > SynchronizeVertex::getReason(const BasicVertex& paren
 			new system::Resolver::SynchronizationReason(versionParent->version, targetPackageName));
 }
 
-bool SynchronizeVertex::isAnti() const
+bool SynchronizeVertex::computeIsAnti() const
 {
 	return true;
 }
@@ -311,7 +319,6 @@ struct UnsatisfiedVertex: public BasicVertex
 	Element parent;
 
 	string toString() const;
-	const vector<Element>* getRelatedElements() const;
 	Unsatisfied::Type getUnsatisfiedType() const;
 };
 
@@ -321,11 +328,6 @@ string UnsatisfiedVertex::toString() const
 	return u + parent->toString();
 }
 
-const vector<Element>* UnsatisfiedVertex::getRelatedElements() const
-{
-	return NULL;
-}
-
 Unsatisfied::Type UnsatisfiedVertex::getUnsatisfiedType() const
 {
 	return parent->getUnsatisfiedType();
@@ -391,11 +393,11 @@ struct UserRelationExpressionVertex: public ExtendedBasicVertex
 		, typePriority(getTypePriorityForUserRequest(ure))
 		, annotation(ure.annotation)
 	{}
-	size_t getTypePriority() const
+	size_t computeTypePriority() const
 	{
 		return typePriority;
 	}
-	bool isAnti() const
+	bool computeIsAnti() const
 	{
 		return invert;
 	}
@@ -417,6 +419,45 @@ struct UserRelationExpressionVertex: public ExtendedBasicVertex
 	}
 };
 
+// the request to upgrade an installed package; there is one for every
+// installed package on upgrades, so the annotation is composed on demand
+struct UpgradeRequestVertex: public ExtendedBasicVertex
+{
+	const BinaryVersion* installedVersion;
+
+	UpgradeRequestVertex(const BinaryVersion* installedVersion_)
+		: installedVersion(installedVersion_)
+	{}
+	size_t computeTypePriority() const
+	{
+		return VertexTypePriority::WishRequest;
+	}
+	bool computeIsAnti() const
+	{
+		return true;
+	}
+	bool asAuto() const
+	{
+		return true;
+	}
+	string getAnnotation() const
+	{
+		return "upgrade " + installedVersion->packageName;
+	}
+	shared_ptr< const Reason > getReason(const BasicVertex&) const
+	{
+		return std::make_shared< const AnnotatedUserReason >(getAnnotation());
+	}
+	string toString() const
+	{
+		return "custom: " + getAnnotation();
+	}
+	const string& getSpecificPackageName() const
+	{
+		return installedVersion->packageName;
+	}
+};
+
 bool __is_version_array_intersects_with_packages(
 		const vector< const BinaryVersion* >& versions,
 		const map< string, const BinaryVersion* >& oldPackages)
@@ -546,8 +587,9 @@ vector< DependencyEntry > __get_dependency_groups(const Config& config)
 	return result;
 }
 
-DependencyGraph::DependencyGraph(const Config& config, const Cache& cache)
-	: __config(config), __cache(cache)
+DependencyGraph::DependencyGraph(const Config& config, const Cache& cache, GraphCache* graphCache)
+	: __config(config), __cache(cache), p_firstElementId(BasicVertex::__next_id),
+	p_graphCache(graphCache), p_graphCacheHits(0)
 {}
 
 DependencyGraph::~DependencyGraph()
@@ -615,6 +657,7 @@ class DependencyGraph::FillHelper
 	unordered_map< string, list<const ExtendedBasicVertex*> > __meta_anti_relation_expression_vertices;
 	unordered_map< pair<string,string>, list<const SynchronizeVertex*> > __meta_synchronize_map;
 	Element p_dummyElementPtr;
+	size_t p_requestsElementCount;
 
 	set<Element> __unfolded_elements;
 
@@ -631,6 +674,7 @@ class DependencyGraph::FillHelper
 		: __dependency_graph(dependencyGraph)
 		, __old_packages(oldPackages)
 		, __debugging(__dependency_graph.__config.getBool("debug::resolver"))
+		, p_requestsElementCount(0)
 	{
 		__synchronize_level = __get_synchronize_level(__dependency_graph.__config);
 		__dependency_groups= __get_dependency_groups(__dependency_graph.__config);
@@ -638,26 +682,27 @@ class DependencyGraph::FillHelper
 	}
 
  private:
+	const VersionVertex* makeVertex(const string& packageName, const BinaryVersion* version)
+	{
+		auto relatedVertexPtrsIt = __package_name_to_vertex_ptrs.insert(
+				{ packageName, RelatedVertexPtrs() }).first;
+		auto vertexPtr(new VersionVertex(relatedVertexPtrsIt));
+		vertexPtr->version = version;
+
+		auto& relatedVertexes = relatedVertexPtrsIt->second;
+		// keep first element (family key) always the same
+		relatedVertexes.push_back(vertexPtr);
+
+		__dependency_graph.p_addVertex(vertexPtr);
+
+		return vertexPtr;
+	}
+
 	template< typename IsVertexAllowedT >
 	const VersionVertex* getVertexPtr(const string& packageName, const BinaryVersion* version,
 			const void* hashValue, const IsVertexAllowedT& isVertexAllowed,
 			bool overrideChecks = false)
 	{
-		auto makeVertex = [this, &packageName, &version]() -> const VersionVertex*
-		{
-			auto relatedVertexPtrsIt = __package_name_to_vertex_ptrs.insert(
-					{ packageName, RelatedVertexPtrs() }).first;
-			auto vertexPtr(new VersionVertex(relatedVertexPtrsIt));
-			vertexPtr->version = version;
-			__dependency_graph.addVertex(vertexPtr);
-
-			auto& relatedVertexes = relatedVertexPtrsIt->second;
-			// keep first element (family key) always the same
-			relatedVertexes.push_back(vertexPtr);
-
-			return vertexPtr;
-		};
-
 		auto insertResult = __version_to_vertex_ptr.insert({ hashValue, nullptr });
 		bool isNew = insertResult.second;
 		const VersionVertex** elementPtrPtr = &insertResult.first->second;
@@ -665,7 +710,7 @@ class DependencyGraph::FillHelper
 		if ((isNew && isVertexAllowed()) || (overrideChecks && !*elementPtrPtr))
 		{
 			// needs new vertex
-			*elementPtrPtr = makeVertex();
+			*elementPtrPtr = makeVertex(packageName, version);
 		}
 		return *elementPtrPtr;
 	}
@@ -725,7 +770,7 @@ class DependencyGraph::FillHelper
 			auto vertex(new RelationExpressionVertex);
 			vertex->dependencyType = dependencyType;
 			vertex->relationExpressionPtr = relationExpressionPtr;
-			element = __dependency_graph.addVertex(vertex);
+			element = __dependency_graph.p_addVertex(vertex);
 		}
 		return element;
 	}
@@ -801,10 +846,10 @@ class DependencyGraph::FillHelper
 				subVertex->dependencyType = dependencyType;
 				subVertex->relationExpressionPtr = &relationExpression;
 				subVertex->specificPackageName = packageName;
-				__dependency_graph.addVertex(subVertex);
+				__dependency_graph.p_addVertex(subVertex);
 				return subVertex;
 			};
-			auto satisfyingVersions = __dependency_graph.__cache.getSatisfyingVersions(relationExpression);
+			auto satisfyingVersions = __dependency_graph.p_getSatisfyingVersions(relationExpression);
 			buildEdgesForAntiRelationExpression(&packageNameToSubElements, satisfyingVersions, createVertex);
 		}
 		for (const auto& it: packageNameToSubElements)
@@ -828,7 +873,7 @@ class DependencyGraph::FillHelper
 		if (dependencyType == BinaryVersion::RelationTypes::Recommends ||
 				dependencyType == BinaryVersion::RelationTypes::Suggests)
 		{
-			satisfyingVersions = __dependency_graph.__cache.getSatisfyingVersions(relationExpression);
+			satisfyingVersions = __dependency_graph.p_getSatisfyingVersions(relationExpression);
 			if (__is_soft_dependency_ignored(__dependency_graph.__config, version, dependencyType,
 					relationExpression, satisfyingVersions, __old_packages))
 			{
@@ -855,7 +900,7 @@ class DependencyGraph::FillHelper
 
 		if (!calculatedSatisfyingVersions)
 		{
-			satisfyingVersions = __dependency_graph.__cache.getSatisfyingVersions(relationExpression);
+			satisfyingVersions = __dependency_graph.p_getSatisfyingVersions(relationExpression);
 		}
 
 		FORIT(satisfyingVersionIt, satisfyingVersions)
@@ -871,7 +916,7 @@ class DependencyGraph::FillHelper
 		{
 			auto notSatisfiedVertex(new UnsatisfiedVertex);
 			notSatisfiedVertex->parent = relationExpressionVertexPtr;
-			addEdgeCustom(relationExpressionVertexPtr, __dependency_graph.addVertex(notSatisfiedVertex));
+			addEdgeCustom(relationExpressionVertexPtr, __dependency_graph.p_addVertex(notSatisfiedVertex));
 		}
 	}
 
@@ -892,7 +937,7 @@ class DependencyGraph::FillHelper
 
 				auto syncVertex = new SynchronizeVertex(__synchronize_level > 1);
 				syncVertex->targetPackageName = packageName;
-				__dependency_graph.addVertex(syncVertex);
+				__dependency_graph.p_addVertex(syncVertex);
 
 				for (auto relatedVersion: *package)
 				{
@@ -914,7 +959,7 @@ class DependencyGraph::FillHelper
 				{
 					auto unsatisfiedVertex = new UnsatisfiedVertex;
 					unsatisfiedVertex->parent = syncVertex;
-					addEdgeCustom(syncVertex, __dependency_graph.addVertex(unsatisfiedVertex));
+					addEdgeCustom(syncVertex, __dependency_graph.p_addVertex(unsatisfiedVertex));
 				}
 
 				subElementPtrs.push_back(syncVertex);
@@ -935,7 +980,7 @@ class DependencyGraph::FillHelper
 	{
 		auto vertex = new CustomUnsatisfiedVertex(importance);
 		vertex->parent = parent;
-		return __dependency_graph.addVertex(vertex);
+		return __dependency_graph.p_addVertex(vertex);
 	}
 
  public:
@@ -945,7 +990,7 @@ class DependencyGraph::FillHelper
 		{
 			return; // processed already
 		}
-		auto versionElement = dynamic_cast<VersionElement>(element);
+		auto versionElement = element->asVersion();
 		if (!versionElement)
 		{
 			return; // nothing to process
@@ -982,21 +1027,40 @@ class DependencyGraph::FillHelper
 		}
 	}
 
+	bool isUnfolded(Element element) const
+	{
+		return __unfolded_elements.count(element);
+	}
+
+	size_t getUnfoldedElementCount() const
+	{
+		return __unfolded_elements.size();
+	}
+
 	Element getDummyElementPtr() const
 	{
 		return p_dummyElementPtr;
 	}
 
-	void addUserRelationExpression(const UserRelationExpression& ure)
+	Element createRequestsElement()
+	{
+		return makeVertex(format2("<user requests %zu>", ++p_requestsElementCount), nullptr);
+	}
+
+	void addUserRelationExpression(const UserRelationExpression& ure, Element requestsElement)
 	{
 		Element unsatisfiedElement = nullptr;
+		if (!requestsElement)
+		{
+			requestsElement = p_dummyElementPtr;
+		}
 
 		auto createVertex = [&](const string& packageName) -> const ExtendedBasicVertex*
 		{
 			auto vertex = new UserRelationExpressionVertex(ure);
 			vertex->specificPackageName = packageName;
-			__dependency_graph.addVertex(vertex);
-			addEdgeCustom(p_dummyElementPtr, vertex);
+			__dependency_graph.p_addVertex(vertex);
+			addEdgeCustom(requestsElement, vertex);
 			if (ure.importance != RequestImportance::Must)
 			{
 				if (!unsatisfiedElement) unsatisfiedElement = createCustomUnsatisfiedElement(vertex, ure.importance);
@@ -1021,6 +1085,43 @@ class DependencyGraph::FillHelper
 			buildEdgesForAntiRelationExpression(&subElements, satisfyingVersions, createVertex, true);
 		}
 	}
+
+	// equal to a Wish request to unsatisfy '<package> (== <pinned not higher
+	// than installed>)' for every installed package, without building and
+	// parsing the relation expressions
+	void addUpgradeRequests()
+	{
+		for (const auto& item: __old_packages)
+		{
+			auto installedVersion = item.second;
+			const string& packageName = installedVersion->packageName;
+
+			auto package = __dependency_graph.__cache.getBinaryPackage(packageName);
+			if (!package) fatal2i("the binary package '%s' doesn't exist", packageName);
+			auto sortedPinnedVersions = __dependency_graph.__cache.getSortedVersionsWithPriorities(package);
+			if (sortedPinnedVersions.front().version == installedVersion) continue;
+
+			auto vertex = new UpgradeRequestVertex(installedVersion);
+			__dependency_graph.p_addVertex(vertex);
+			addEdgeCustom(p_dummyElementPtr, vertex);
+			addEdgeCustom(vertex, createCustomUnsatisfiedElement(vertex, RequestImportance::Wish));
+
+			for (const auto& pinnedVersion: sortedPinnedVersions)
+			{
+				if (pinnedVersion.version == installedVersion) break;
+
+				auto packageVersion = static_cast< const BinaryVersion* >(pinnedVersion.version);
+				if (auto queuedVersionPtr = getVertexPtrForVersion(packageVersion, true))
+				{
+					addEdgeCustom(vertex, queuedVersionPtr);
+				}
+			}
+			if (auto emptyPackageElementPtr = getVertexPtrForEmptyPackage(packageName, package, true))
+			{
+				addEdgeCustom(vertex, emptyPackageElementPtr);
+			}
+		}
+	}
 };
 
 vector< pair< dg::Element, shared_ptr< const PackageEntry > > > DependencyGraph::fill(
@@ -1037,6 +1138,21 @@ vector< pair< dg::Element, shared_ptr< const PackageEntry > > > DependencyGraph:
 	return p_generateSolutionElements(oldPackages);
 }
 
+Element DependencyGraph::p_addVertex(BasicVertex* vertex)
+{
+	vertex->p_fixProperties();
+	return addVertex(vertex);
+}
+
+vector< const BinaryVersion* > DependencyGraph::p_getSatisfyingVersions(const RelationExpression& relationExpression)
+{
+	if (p_graphCache)
+	{
+		return p_graphCache->getSatisfyingVersions(relationExpression, &p_graphCacheHits);
+	}
+	return __cache.getSatisfyingVersions(relationExpression);
+}
+
 void DependencyGraph::p_populatePackage(const string& packageName)
 {
 	auto package = __cache.getBinaryPackage(packageName);
@@ -1078,9 +1194,19 @@ vector< pair< dg::Element, shared_ptr< const PackageEntry > > > DependencyGraph:
 	return result;
 }
 
-void DependencyGraph::addUserRelationExpression(const UserRelationExpression& ure)
+void DependencyGraph::addUserRelationExpression(const UserRelationExpression& ure, Element requestsElement)
+{
+	__fill_helper->addUserRelationExpression(ure, requestsElement);
+}
+
+void DependencyGraph::addUpgradeRequests()
 {
-	__fill_helper->addUserRelationExpression(ure);
+	__fill_helper->addUpgradeRequests();
+}
+
+Element DependencyGraph::createRequestsElement()
+{
+	return __fill_helper->createRequestsElement();
 }
 
 void DependencyGraph::unfoldElement(Element element)
@@ -1088,13 +1214,45 @@ void DependencyGraph::unfoldElement(Element element)
 	__fill_helper->unfoldElement(element);
 }
 
+bool DependencyGraph::isUnfolded(Element element) const
+{
+	return __fill_helper->isUnfolded(element);
+}
+
+size_t DependencyGraph::getVertexCount() const
+{
+	return getVertices().size();
+}
+
+size_t DependencyGraph::getUnfoldedElementCount() const
+{
+	return __fill_helper->getUnfoldedElementCount();
+}
+
+Element DependencyGraph::findCorrespondingEmptyElement(Element element) const
+{
+	// if created already, the empty element is in the same family
+	for (auto relatedElement: *element->getRelatedElements())
+	{
+		if (!static_cast<VersionElement>(relatedElement)->version)
+		{
+			return relatedElement;
+		}
+	}
+	return nullptr;
+}
+
 Element DependencyGraph::getCorrespondingEmptyElement(Element element)
 {
-	auto versionVertex = dynamic_cast<VersionElement>(element);
+	auto versionVertex = element->asVersion();
 	if (!versionVertex)
 	{
 		fatal2i("getting corresponding empty element for non-version vertex");
 	}
+	if (auto existingElement = findCorrespondingEmptyElement(element))
+	{
+		return existingElement;
+	}
 	const string& packageName = versionVertex->getPackageName();
 	auto package = __cache.getBinaryPackage(packageName);
 	return __fill_helper->getVertexPtrForEmptyPackage(packageName, package);
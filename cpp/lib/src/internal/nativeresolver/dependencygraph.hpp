@@ -36,6 +36,7 @@ namespace cupt {
 namespace internal {
 
 struct PackageEntry;
+class GraphCache;
 
 namespace dependencygraph {
 
@@ -55,23 +56,44 @@ struct Unsatisfied
 
 struct BasicVertex;
 typedef const BasicVertex* Element;
+struct VersionVertex;
+typedef const VersionVertex* VersionElement;
 struct BasicVertex
 {
  private:
 	static uint32_t __next_id;
+
+	// the properties queried in the resolver loops are computed once, when
+	// the vertex is added to the graph, and are read without virtual calls
+	friend class DependencyGraph;
+	Element p_familyKey;
+	const vector<Element>* p_relatedElements;
+	uint8_t p_typePriority;
+	bool p_isAnti;
+	const bool p_isVersion;
+
+	void p_fixProperties();
+ protected:
+	virtual size_t computeTypePriority() const;
+	virtual bool computeIsAnti() const;
+	virtual const vector<Element>* computeRelatedElements() const;
+	virtual Element computeFamilyKey() const;
+
+	BasicVertex(bool isVersion = false);
  public:
 	const uint32_t id;
 	virtual string toString() const = 0;
-	virtual size_t getTypePriority() const;
 	virtual shared_ptr< const Reason > getReason(const BasicVertex& parent) const;
-	virtual bool isAnti() const;
-	virtual const vector<Element>* getRelatedElements() const;
 	virtual Unsatisfied::Type getUnsatisfiedType() const;
 	virtual const RequestImportance& getUnsatisfiedImportance() const;
 	virtual bool asAuto() const;
-	virtual Element getFamilyKey() const;
 
-	BasicVertex();
+	size_t getTypePriority() const { return p_typePriority; }
+	bool isAnti() const { return p_isAnti; }
+	const vector<Element>* getRelatedElements() const { return p_relatedElements; }
+	Element getFamilyKey() const { return p_familyKey; }
+	VersionElement asVersion() const; // nullptr for non-version vertices
+
 	virtual ~BasicVertex();
 };
 struct VersionVertex: public BasicVertex
@@ -79,17 +101,22 @@ struct VersionVertex: public BasicVertex
  private:
 	typedef map< string, vector<Element> > FamilyMap;
 	const FamilyMap::iterator __related_element_ptrs_it;
+ protected:
+	const vector<Element>* computeRelatedElements() const;
+	Element computeFamilyKey() const;
  public:
 	const BinaryVersion* version;
 
 	VersionVertex(const FamilyMap::iterator&);
 	string toString() const;
-	const vector<Element>* getRelatedElements() const;
 	const string& getPackageName() const;
 	string toLocalizedString() const;
-	Element getFamilyKey() const;
 };
-typedef const VersionVertex* VersionElement;
+
+inline VersionElement BasicVertex::asVersion() const
+{
+	return p_isVersion ? static_cast< VersionElement >(this) : nullptr;
+}
 
 namespace {
 
@@ -109,6 +136,9 @@ class DependencyGraph: protected Graph< Element, PointeredAlreadyTraits >
 {
 	const Config& __config;
 	const Cache& __cache;
+	const uint32_t p_firstElementId;
+	GraphCache* p_graphCache; // nullptr if the graph cache is off
+	size_t p_graphCacheHits;
 
 	class FillHelper;
 	friend class FillHelper;
@@ -118,23 +148,69 @@ class DependencyGraph: protected Graph< Element, PointeredAlreadyTraits >
 	vector< pair< Element, shared_ptr< const PackageEntry > > > p_generateSolutionElements(
 			const map< string, const BinaryVersion* >&);
 	void p_populatePackage(const string& packageName);
+	Element p_addVertex(BasicVertex*);
+	vector< const BinaryVersion* > p_getSatisfyingVersions(const RelationExpression&);
  public:
 	typedef Graph< Element, PointeredAlreadyTraits > BaseT;
 
-	DependencyGraph(const Config& config, const Cache& cache);
+	DependencyGraph(const Config& config, const Cache& cache, GraphCache*);
 	~DependencyGraph();
 	vector< pair< Element, shared_ptr< const PackageEntry > > > fill(
 			const map< string, const BinaryVersion* >&);
-	void addUserRelationExpression(const UserRelationExpression&);
+	// attaches the request to the given requests element, to the common one by default
+	void addUserRelationExpression(const UserRelationExpression&, Element requestsElement = nullptr);
+	// requests to upgrade every installed package, attached to the common requests element
+	void addUpgradeRequests();
+	// a new element for requests resolved independently of the common ones
+	Element createRequestsElement();
 
 	Element getCorrespondingEmptyElement(Element);
+	Element findCorrespondingEmptyElement(Element) const; // only existing one, for version elements
 	void unfoldElement(Element);
+	bool isUnfolded(Element) const;
+
+	size_t getVertexCount() const;
+	uint32_t getFirstElementId() const { return p_firstElementId; }
+	size_t getUnfoldedElementCount() const;
+	size_t getGraphCacheHitCount() const { return p_graphCacheHits; }
 
 	using BaseT::getSuccessors;
 	using BaseT::getPredecessors;
 	using BaseT::CessorListType;
 };
 
+/* values for the elements of one graph: the ids of its elements go up from
+   the first one, so the values are kept in an array instead of a tree */
+template < typename T >
+class ElementTable
+{
+	uint32_t p_firstId;
+	T p_defaultValue;
+	vector< T > p_values;
+ public:
+	ElementTable(uint32_t firstId = 0, const T& defaultValue = T())
+		: p_firstId(firstId), p_defaultValue(defaultValue)
+	{}
+	const T& get(Element element) const
+	{
+		size_t index = element->id - p_firstId;
+		return index < p_values.size() ? p_values[index] : p_defaultValue;
+	}
+	T& operator[](Element element)
+	{
+		size_t index = element->id - p_firstId;
+		if (index >= p_values.size())
+		{
+			p_values.resize(index + 1, p_defaultValue);
+		}
+		return p_values[index];
+	}
+	void clear()
+	{
+		p_values.clear();
+	}
+};
+
 }
 }
 }
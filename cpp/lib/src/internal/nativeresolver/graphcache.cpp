@@ -0,0 +1,302 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <algorithm>
+
+#include <cupt/config.hpp>
+#include <cupt/cache.hpp>
+#include <cupt/cache/binarypackage.hpp>
+#include <cupt/cache/binaryversion.hpp>
+#include <cupt/system/state.hpp>
+#include <cupt/file.hpp>
+#include <cupt/hashsums.hpp>
+
+#include <internal/nativeresolver/graphcache.hpp>
+#include <internal/nativeresolver/solutioncache.hpp>
+#include <internal/common.hpp>
+#include <internal/filesystem.hpp>
+
+namespace cupt {
+namespace internal {
+
+namespace {
+
+const string optionName = "cupt::resolver::graph-cache-directory";
+
+// the options which change the set of versions in the indexes
+bool isKeyOption(const string& name)
+{
+	static const vector< string > prefixes = {
+		"apt::architecture", "cupt::cache::foreign-architectures", "cupt::cache::limit-releases::" };
+
+	for (const auto& prefix: prefixes)
+	{
+		if (name.compare(0, prefix.size(), prefix) == 0) return true;
+	}
+	return false;
+}
+
+string getKey(const Config& config, const Cache& cache)
+{
+	string result = getIndexesKey(config, cache);
+
+	for (const auto& name: config.getScalarOptionNames())
+	{
+		if (!isKeyOption(name)) continue;
+		result += format2("option %s %s\n", name, config.getString(name));
+	}
+	for (const auto& name: config.getListOptionNames())
+	{
+		if (!isKeyOption(name)) continue;
+		result += format2("option %s %s\n", name, join(" ", config.getList(name)));
+	}
+
+	return result;
+}
+
+// the same order as the cache gives
+void sortByPackageNameAndVersion(vector< const BinaryVersion* >* versions)
+{
+	std::sort(versions->begin(), versions->end(), [](const BinaryVersion* left, const BinaryVersion* right)
+			{
+				return std::forward_as_tuple(left->packageName, right->versionString) <
+						std::forward_as_tuple(right->packageName, left->versionString);
+			});
+}
+
+bool isBroken(const Cache& cache, const BinaryVersion* installedVersion)
+{
+	return cache.getSystemState()->getInstalledInfo(installedVersion->packageName)->isBroken();
+}
+
+}
+
+GraphCache::GraphCache(const Config& config, const Cache& cache)
+	: p_cache(cache), p_loaded(false)
+{
+	auto directory = config.getString(optionName);
+	if (directory.empty()) return;
+
+	p_path = directory + '/' + HashSums::getHashOfString(HashSums::SHA256, getKey(config, cache));
+}
+
+void GraphCache::p_load()
+{
+	if (p_loaded) return;
+	p_loaded = true;
+
+	for (auto version: p_cache.getInstalledVersions())
+	{
+		p_installedVersions[version->packageName] = version;
+		for (const auto& provide: version->provides)
+		{
+			auto providedVersionString = (provide.relationType == Relation::Types::None) ?
+					string() : provide.versionString;
+			p_installedProviders[provide.packageName].emplace_back(version, providedVersionString);
+		}
+	}
+
+	if (!fs::fileExists(p_path)) return;
+
+	string openError;
+	File file(p_path, "r", openError);
+	if (!openError.empty())
+	{
+		warn2(__("unable to open the file '%s': %s"), p_path, openError);
+		return;
+	}
+
+	VersionIds* versionIds = nullptr;
+	string line;
+	while (!file.getLine(line).eof())
+	{
+		auto spacePosition = line.find(' ');
+		auto kind = line.substr(0, spacePosition);
+		if (kind == "relation" && spacePosition != string::npos)
+		{
+			versionIds = &p_storedVersionIds[line.substr(spacePosition + 1)];
+			continue;
+		}
+		auto secondSpacePosition = line.find(' ', spacePosition + 1);
+		if (kind == "version" && versionIds && secondSpacePosition != string::npos)
+		{
+			versionIds->emplace_back(line.substr(spacePosition + 1, secondSpacePosition - spacePosition - 1),
+					line.substr(secondSpacePosition + 1));
+			continue;
+		}
+
+		warn2(__("the cached dependency graph '%s' is malformed"), p_path);
+		p_storedVersionIds.clear();
+		return;
+	}
+}
+
+bool GraphCache::p_getStoredVersions(const VersionIds& versionIds, vector< const BinaryVersion* >* result) const
+{
+	for (const auto& versionId: versionIds)
+	{
+		auto package = p_cache.getBinaryPackage(versionId.first);
+		if (!package) return false;
+		auto version = package->getSpecificVersion(versionId.second);
+		if (!version) return false;
+		result->push_back(static_cast< const BinaryVersion* >(version));
+	}
+	return true;
+}
+
+// the installed part of Cache::getSatisfyingVersions, for the relations without an architecture
+void GraphCache::p_addInstalledVersions(const Relation& relation, vector< const BinaryVersion* >* result) const
+{
+	auto installedIt = p_installedVersions.find(relation.packageName);
+	if (installedIt != p_installedVersions.end())
+	{
+		auto version = installedIt->second;
+		if (relation.isSatisfiedBy(version->versionString) &&
+				(!isBroken(p_cache, version) || relation.relationType == Relation::Types::LiteralyEqual))
+		{
+			result->push_back(version);
+		}
+	}
+
+	auto providersIt = p_installedProviders.find(relation.packageName);
+	if (providersIt != p_installedProviders.end())
+	{
+		vector< const BinaryVersion* > providingVersions;
+		for (const auto& provider: providersIt->second)
+		{
+			const string& providedVersionString = provider.second;
+			if (relation.relationType != Relation::Types::None &&
+					(providedVersionString.empty() || !relation.isSatisfiedBy(providedVersionString)))
+			{
+				continue;
+			}
+			if (isBroken(p_cache, provider.first))
+			{
+				continue;
+			}
+			providingVersions.push_back(provider.first);
+		}
+		std::sort(providingVersions.begin(), providingVersions.end());
+		providingVersions.erase(std::unique(providingVersions.begin(), providingVersions.end()),
+				providingVersions.end());
+		result->insert(result->end(), providingVersions.begin(), providingVersions.end());
+	}
+}
+
+vector< const BinaryVersion* > GraphCache::p_getSatisfyingVersions(const Relation& relation, size_t* hitCount)
+{
+	auto key = relation.toString();
+
+	auto it = p_storedVersionIds.find(key);
+	if (it != p_storedVersionIds.end())
+	{
+		vector< const BinaryVersion* > result;
+		if (p_getStoredVersions(it->second, &result))
+		{
+			p_addInstalledVersions(relation, &result);
+			sortByPackageNameAndVersion(&result);
+			++*hitCount;
+			return result;
+		}
+		// the indexes have changed in a way the key doesn't reflect
+	}
+
+	RelationExpression relationExpression;
+	relationExpression.push_back(relation);
+	auto result = p_cache.getSatisfyingVersions(relationExpression);
+
+	VersionIds versionIds;
+	for (auto version: result)
+	{
+		if (version->isInstalled()) continue;
+		if (version->versionString.find(idSuffixDelimiter) != string::npos)
+		{
+			return result; // the suffix may be different in the next run
+		}
+		versionIds.emplace_back(version->packageName, version->versionString);
+	}
+	p_newVersionIds[key] = std::move(versionIds);
+
+	return result;
+}
+
+vector< const BinaryVersion* > GraphCache::getSatisfyingVersions(
+		const RelationExpression& relationExpression, size_t* hitCount)
+{
+	for (const auto& relation: relationExpression)
+	{
+		if (!relation.architecture.empty())
+		{
+			return p_cache.getSatisfyingVersions(relationExpression);
+		}
+	}
+	p_load();
+
+	// alternatives are merged as the cache does it
+	auto result = p_getSatisfyingVersions(relationExpression[0], hitCount);
+	for (auto relationIt = relationExpression.begin() + 1; relationIt != relationExpression.end(); ++relationIt)
+	{
+		for (auto version: p_getSatisfyingVersions(*relationIt, hitCount))
+		{
+			if (std::find(result.begin(), result.end(), version) == result.end())
+			{
+				result.push_back(version);
+			}
+		}
+	}
+	return result;
+}
+
+void GraphCache::store()
+{
+	if (p_newVersionIds.empty()) return;
+	for (auto& item: p_newVersionIds)
+	{
+		p_storedVersionIds[item.first] = std::move(item.second);
+	}
+	p_newVersionIds.clear();
+
+	auto directory = fs::dirname(p_path);
+	if (!fs::dirExists(directory))
+	{
+		fs::mkpath(directory);
+	}
+
+	auto temporaryPath = p_path + ".new";
+	{
+		string openError;
+		File file(temporaryPath, "w", openError);
+		if (!openError.empty())
+		{
+			warn2(__("unable to open the file '%s': %s"), temporaryPath, openError);
+			return;
+		}
+		for (const auto& item: p_storedVersionIds)
+		{
+			file.put("relation " + item.first + '\n');
+			for (const auto& versionId: item.second)
+			{
+				file.put("version " + versionId.first + ' ' + versionId.second + '\n');
+			}
+		}
+	}
+	fs::move(temporaryPath, p_path);
+}
+
+}
+}
+
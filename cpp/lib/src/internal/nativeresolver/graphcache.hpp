@@ -0,0 +1,67 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_NATIVERESOLVER_GRAPHCACHE_SEEN
+#define CUPT_INTERNAL_NATIVERESOLVER_GRAPHCACHE_SEEN
+
+#include <unordered_map>
+
+#include <cupt/cache/relation.hpp>
+
+#include <internal/nativeresolver/dependencygraph.hpp>
+
+namespace cupt {
+namespace internal {
+
+using cache::Relation;
+
+/* the versions satisfying the relations of the dependency graph, as far as
+   they come from the indexes, stored in a directory, one file per state of
+   the indexes; the installed versions differ from host to host, so they are
+   added to the stored ones in every run */
+class GraphCache
+{
+	typedef vector< pair< string, string > > VersionIds; // package names and version strings
+
+	const Cache& p_cache;
+	string p_path; // empty if the cache is off
+	bool p_loaded;
+	std::unordered_map< string, VersionIds > p_storedVersionIds; // by relation
+	std::unordered_map< string, VersionIds > p_newVersionIds;
+
+	std::unordered_map< string, const BinaryVersion* > p_installedVersions;
+	// the installed versions with the provided version strings
+	std::unordered_map< string, vector< pair< const BinaryVersion*, string > > > p_installedProviders;
+
+	void p_load();
+	bool p_getStoredVersions(const VersionIds&, vector< const BinaryVersion* >*) const;
+	void p_addInstalledVersions(const Relation&, vector< const BinaryVersion* >*) const;
+	vector< const BinaryVersion* > p_getSatisfyingVersions(const Relation&, size_t* hitCount);
+ public:
+	GraphCache(const Config&, const Cache&);
+
+	bool isEnabled() const { return !p_path.empty(); }
+	// the same as Cache::getSatisfyingVersions, counts the relations found stored
+	vector< const BinaryVersion* > getSatisfyingVersions(const RelationExpression&, size_t* hitCount);
+	void store();
+};
+
+}
+}
+
+#endif
+
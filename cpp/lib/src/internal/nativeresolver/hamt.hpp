@@ -1,5 +1,5 @@
 /**************************************************************************
-*   Copyright (C) 2014 by Eugene V. Lyubimkin                             *
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
 *                                                                         *
 *   This program is free software; you can redistribute it and/or modify  *
 *   it under the terms of the GNU General Public License                  *
@@ -15,24 +15,33 @@
 *   Free Software Foundation, Inc.,                                       *
 *   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
 **************************************************************************/
-#ifndef CUPT_COW_MAP_SEEN
-#define CUPT_COW_MAP_SEEN
+#ifndef CUPT_HAMT_SEEN
+#define CUPT_HAMT_SEEN
 
 namespace cupt {
 namespace internal {
 
+/* persistent hash array mapped trie of modifications on top of an initial
+   map; copying is O(1), lookups and modifications are O(log32 n) and share
+   all untouched nodes with the copies
+
+   the keys must have unique 'id's, which are used as hashes; for records
+   having a rank, every subtrie knows its maximum rank, so the records of the
+   maximum rank are found without visiting the others */
 template < typename KeyT, typename MapT >
-class CowMap
+class Hamt
 {
+	struct Node;
+	struct Impl;
+
 	const MapT* p_initial;
-	shared_ptr< const MapT > p_master;
-	shared_ptr< MapT > p_added;
+	shared_ptr< Node > p_root;
 
-	CowMap(const CowMap&) = delete;
+	Hamt(const Hamt&) = delete;
  public:
-	CowMap();
+	Hamt();
 	void setInitialMap(const MapT*);
-	void operator=(const CowMap&);
+	void operator=(const Hamt&);
 
 	// only for maps without removals
 	template < typename Data >
@@ -42,11 +51,14 @@ class CowMap
 	const DataT* get(KeyT) const;
 	template < typename DataT >
 	void add(KeyT, DataT&&);
+	// for records containing more than a key and data
+	template < typename RecordT >
+	void addRecord(RecordT&&);
 	void remove(KeyT);
 	template < typename CallbackT >
 	void foreachModifiedEntry(const CallbackT&) const;
-
-	void shrinkToFit();
+	template < typename CallbackT >
+	void foreachModifiedEntryOfMaxRank(const CallbackT&) const;
 };
 
 }
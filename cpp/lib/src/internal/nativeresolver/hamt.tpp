@@ -0,0 +1,399 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_HAMT_IMPL_SEEN
+#define CUPT_HAMT_IMPL_SEEN
+
+namespace cupt {
+namespace internal {
+
+namespace {
+
+template < typename T >
+const typename T::second_type& getHamtRecordData(const T& record)
+{
+	return record.second;
+}
+
+const size_t& getHamtRecordData(const BrokenSuccessor& bs)
+{
+	return bs.priority;
+}
+
+template < typename T >
+struct HamtRecordRanked
+{
+	static const bool value = false;
+};
+template < typename T >
+size_t getHamtRecordRank(const T&)
+{
+	return 0;
+}
+
+template <>
+struct HamtRecordRanked< BrokenSuccessor >
+{
+	static const bool value = true;
+};
+// the order of the problems of the solution, without the per-step parts
+size_t getHamtRecordRank(const BrokenSuccessor& bs)
+{
+	return bs.priority ? (bs.typePriority << 32) + bs.priority : 0;
+}
+
+const size_t hamtBitsPerLevel = 5;
+const uint32_t hamtLevelMask = (1u << hamtBitsPerLevel) - 1;
+
+}
+
+template < typename KeyT, typename MapT >
+struct Hamt<KeyT,MapT>::Node
+{
+	typedef typename MapT::value_type ValueT;
+	typedef shared_ptr< Node > NodePtr;
+
+	struct Entry
+	{
+		NodePtr child; // if set, the entry is a subtrie, otherwise a value
+		ValueT value;
+	};
+
+	uint32_t bitmap; // which of 32 slots are present in 'entries'
+	vector< Entry > entries;
+	size_t maxRank; // of the records in the subtrie
+
+	Node()
+		: bitmap(0), maxRank(0)
+	{}
+
+	size_t getIndex(uint32_t bit) const
+	{
+		return __builtin_popcount(bitmap & (bit - 1));
+	}
+	bool hasSingleValue() const
+	{
+		return entries.size() == 1 && !entries[0].child;
+	}
+	void updateMaxRank()
+	{
+		if (!HamtRecordRanked< ValueT >::value) return;
+
+		maxRank = 0;
+		for (const auto& entry: entries)
+		{
+			auto rank = entry.child ? entry.child->maxRank : getHamtRecordRank(entry.value);
+			maxRank = std::max(maxRank, rank);
+		}
+	}
+};
+
+template < typename KeyT, typename MapT >
+struct Hamt<KeyT,MapT>::Impl
+{
+	typedef typename MapT::value_type ValueT;
+	typedef typename Node::NodePtr NodePtr;
+
+	static NodePtr cloneIfShared(const NodePtr& node)
+	{
+		/* a node owned only by this trie can be modified in place; the
+		   callers clone the ancestors first, so their children are shared
+		   if the ancestors were */
+		if (node.use_count() == 1)
+		{
+			return node;
+		}
+		return std::make_shared< Node >(*node);
+	}
+
+	static NodePtr add(const NodePtr& node, size_t shift, KeyT key, ValueT&& value)
+	{
+		auto result = node ? cloneIfShared(node) : std::make_shared< Node >();
+
+		uint32_t bit = 1u << ((key->id >> shift) & hamtLevelMask);
+		auto index = result->getIndex(bit);
+		if (!(result->bitmap & bit))
+		{
+			result->bitmap |= bit;
+			result->entries.insert(result->entries.begin() + index, { nullptr, std::move(value) });
+			result->updateMaxRank();
+			return result;
+		}
+
+		auto& entry = result->entries[index];
+		if (entry.child)
+		{
+			entry.child = add(entry.child, shift + hamtBitsPerLevel, key, std::move(value));
+		}
+		else
+		{
+			auto existingKey = typename MapT::key_getter_t()(entry.value);
+			if (existingKey == key)
+			{
+				entry.value = std::move(value);
+			}
+			else
+			{
+				// push both values one level down
+				auto child = add(nullptr, shift + hamtBitsPerLevel, existingKey, std::move(entry.value));
+				entry.child = add(child, shift + hamtBitsPerLevel, key, std::move(value));
+				entry.value = ValueT();
+			}
+		}
+		result->updateMaxRank();
+		return result;
+	}
+
+	// 'exclusive' means that no ancestor of the node is shared
+	static bool erase(const NodePtr& node, bool exclusive, size_t shift, KeyT key, NodePtr* result)
+	{
+		exclusive = exclusive && node.use_count() == 1;
+
+		uint32_t bit = 1u << ((key->id >> shift) & hamtLevelMask);
+		if (!(node->bitmap & bit))
+		{
+			return false;
+		}
+		auto index = node->getIndex(bit);
+		const auto& entry = node->entries[index];
+
+		NodePtr newChild;
+		if (entry.child)
+		{
+			if (!erase(entry.child, exclusive, shift + hamtBitsPerLevel, key, &newChild))
+			{
+				return false;
+			}
+		}
+		else if (typename MapT::key_getter_t()(entry.value) != key)
+		{
+			return false;
+		}
+
+		*result = exclusive ? node : std::make_shared< Node >(*node);
+		auto& newEntry = (*result)->entries[index];
+		if (!newChild)
+		{
+			(*result)->bitmap &= ~bit;
+			(*result)->entries.erase((*result)->entries.begin() + index);
+			if ((*result)->entries.empty())
+			{
+				result->reset();
+			}
+		}
+		else if (newChild->hasSingleValue())
+		{
+			// pull the only value up
+			newEntry.value = newChild->entries[0].value;
+			newEntry.child.reset();
+		}
+		else
+		{
+			newEntry.child = std::move(newChild);
+		}
+		if (*result)
+		{
+			(*result)->updateMaxRank();
+		}
+		return true;
+	}
+
+	template < typename CallbackT >
+	static void foreach(const Node& node, const CallbackT& callback)
+	{
+		for (const auto& entry: node.entries)
+		{
+			if (entry.child)
+			{
+				foreach(*entry.child, callback);
+			}
+			else
+			{
+				callback(entry.value);
+			}
+		}
+	}
+
+	template < typename CallbackT >
+	static void foreachOfRank(const Node& node, size_t rank, const CallbackT& callback)
+	{
+		for (const auto& entry: node.entries)
+		{
+			if (entry.child)
+			{
+				if (entry.child->maxRank == rank)
+				{
+					foreachOfRank(*entry.child, rank, callback);
+				}
+			}
+			else if (getHamtRecordRank(entry.value) == rank)
+			{
+				callback(entry.value);
+			}
+		}
+	}
+};
+
+template < typename KeyT, typename MapT >
+Hamt<KeyT,MapT>::Hamt()
+	: p_initial(nullptr)
+{}
+
+template < typename KeyT, typename MapT >
+void Hamt<KeyT,MapT>::setInitialMap(const MapT* map)
+{
+	p_initial = map;
+}
+
+template < typename KeyT, typename MapT >
+void Hamt<KeyT,MapT>::operator=(const Hamt& parent)
+{
+	p_initial = parent.p_initial;
+	p_root = parent.p_root;
+}
+
+template < typename KeyT, typename MapT >
+template < typename DataT >
+void Hamt<KeyT,MapT>::add(KeyT key, DataT&& data)
+{
+	p_root = Impl::add(p_root, 0, key, { key, std::forward< DataT >(data) });
+}
+
+template < typename KeyT, typename MapT >
+template < typename RecordT >
+void Hamt<KeyT,MapT>::addRecord(RecordT&& record)
+{
+	auto key = typename MapT::key_getter_t()(record);
+	p_root = Impl::add(p_root, 0, key, std::forward< RecordT >(record));
+}
+
+template < typename KeyT, typename MapT >
+void Hamt<KeyT,MapT>::remove(KeyT key)
+{
+	typedef typename std::decay<decltype(getHamtRecordData(typename MapT::value_type()))>::type DataT;
+
+	if (p_initial->find(key) != p_initial->end())
+	{
+		// an empty value masks the initial one
+		this->add(key, DataT());
+	}
+	else if (p_root)
+	{
+		shared_ptr< Node > newRoot;
+		if (Impl::erase(p_root, true, 0, key, &newRoot))
+		{
+			p_root = std::move(newRoot);
+		}
+	}
+}
+
+template < typename KeyT, typename MapT >
+template < typename CallbackT >
+void Hamt<KeyT,MapT>::foreachModifiedEntry(const CallbackT& callback) const
+{
+	if (p_root)
+	{
+		Impl::foreach(*p_root, callback);
+	}
+}
+
+// records of rank 0 are skipped
+template < typename KeyT, typename MapT >
+template < typename CallbackT >
+void Hamt<KeyT,MapT>::foreachModifiedEntryOfMaxRank(const CallbackT& callback) const
+{
+	if (p_root && p_root->maxRank)
+	{
+		Impl::foreachOfRank(*p_root, p_root->maxRank, callback);
+	}
+}
+
+template < typename KeyT, typename MapT >
+template < typename DataT >
+vector<const DataT*> Hamt<KeyT,MapT>::getEntries() const
+{
+	typedef typename MapT::value_type ValueT;
+	typedef typename MapT::key_getter_t KeyGetter;
+	auto keyLess = [](const ValueT& left, const ValueT& right)
+	{
+		return KeyGetter()(left) < KeyGetter()(right);
+	};
+
+	vector< ValueT > modified;
+	foreachModifiedEntry([&modified](const ValueT& value) { modified.push_back(value); });
+	std::sort(modified.begin(), modified.end(), keyLess);
+
+	vector<const DataT*> result;
+	class CallbackIterator: public std::iterator< std::output_iterator_tag, ValueT >
+	{
+		vector<const DataT*>& __result;
+	 public:
+		CallbackIterator(vector<const DataT*>& result_)
+			: __result(result_) {}
+		CallbackIterator& operator++() { return *this; }
+		CallbackIterator& operator*() { return *this; }
+		void operator=(const ValueT& data)
+		{
+			__result.push_back(&*data.second);
+		}
+	};
+	// modified entries come first, so they override the initial ones
+	std::set_union(modified.begin(), modified.end(),
+			p_initial->begin(), p_initial->end(),
+			CallbackIterator(result), keyLess);
+
+	return result;
+}
+
+template < typename KeyT, typename MapT >
+template < typename DataT >
+const DataT* Hamt<KeyT,MapT>::get(KeyT key) const
+{
+	const Node* node = p_root.get();
+	size_t shift = 0;
+	while (node)
+	{
+		uint32_t bit = 1u << ((key->id >> shift) & hamtLevelMask);
+		if (!(node->bitmap & bit)) break;
+
+		const auto& entry = node->entries[node->getIndex(bit)];
+		if (!entry.child)
+		{
+			if (typename MapT::key_getter_t()(entry.value) == key)
+			{
+				return &getHamtRecordData(entry.value);
+			}
+			break;
+		}
+		node = entry.child.get();
+		shift += hamtBitsPerLevel;
+	}
+
+	auto it = p_initial->find(key);
+	if (it != p_initial->end())
+	{
+		return &getHamtRecordData(*it);
+	}
+
+	return nullptr; // not found
+}
+
+}
+}
+
+#endif
+
@@ -19,6 +19,7 @@
 #include <cmath>
 #include <queue>
 #include <algorithm>
+#include <limits>
 
 #include <cupt/config.hpp>
 #include <cupt/cache.hpp>
@@ -26,7 +27,8 @@
 #include <cupt/system/state.hpp>
 
 #include <internal/nativeresolver/impl.hpp>
-#include <internal/graph.hpp>
+#include <internal/nativeresolver/speculativepreparer.hpp>
+#include <internal/nativeresolver/satsearch.hpp>
 
 namespace cupt {
 namespace internal {
@@ -34,12 +36,29 @@ namespace internal {
 using std::queue;
 
 NativeResolverImpl::NativeResolverImpl(const shared_ptr< const Config >& config, const shared_ptr< const Cache >& cache)
-	: __config(config), __cache(cache), __score_manager(*config, cache), __auto_removal_possibility(*__config)
+	: __config(config), __cache(cache), __score_manager(*config, cache), __auto_removal_possibility(*__config),
+	p_graphCache(*config, *cache)
 {
 	p_debugging = __config->getBool("debug::resolver");
+	p_anytime = false;
+	p_searchBudgetExhausted = false;
+	p_completionSteps = 0;
+	p_upgradeRequested = false;
+	p_estimating = false;
 	__import_installed_versions();
 }
 
+// the element tables are bound to the graph of the storage
+void NativeResolverImpl::p_resetSolutionStorage()
+{
+	__solution_storage.reset(new SolutionStorage(*__config, *__cache,
+			p_graphCache.isEnabled() ? &p_graphCache : nullptr));
+	auto firstElementId = __solution_storage->getFirstElementId();
+	p_autoRemovalCandidacies = dg::ElementTable< uint8_t >(firstElementId);
+	p_versionPins = dg::ElementTable< ssize_t >(firstElementId, std::numeric_limits< ssize_t >::min());
+	p_fixPenalties = dg::ElementTable< ssize_t >(firstElementId, -1);
+}
+
 void NativeResolverImpl::__import_installed_versions()
 {
 	auto versions = __cache->getInstalledVersions();
@@ -88,6 +107,7 @@ void __mydebug_wrapper(const Solution& solution, size_t id, const Args&... args)
 void NativeResolverImpl::setAutomaticallyInstalledFlag(const string& packageName, bool flagValue)
 {
 	__auto_status_overrides[packageName] = flagValue;
+	p_autoRemovalCandidacies.clear();
 }
 
 namespace {
@@ -111,40 +131,13 @@ void NativeResolverImpl::satisfyRelationExpression(const RelationExpression& re,
 	}
 }
 
-RelationExpression getNotHigherThanInstalledPinRelationExpression(const Cache& cache, const string& packageName)
-{
-	RelationExpression result;
-
-	auto package = cache.getBinaryPackage(packageName);
-	auto sortedPinnedVersions = cache.getSortedVersionsWithPriorities(package);
-	auto installedVersion = package->getInstalledVersion();
-
-	if (sortedPinnedVersions.front().version == installedVersion) return result;
-
-	for (auto it = sortedPinnedVersions.rbegin(); it != sortedPinnedVersions.rend(); ++it)
-	{
-		Relation relation({ packageName.data(), packageName.data()+packageName.size() });
-		relation.relationType = Relation::Types::LiteralyEqual;
-		relation.versionString = it->version->versionString;
-		result.push_back(std::move(relation));
-
-		if (it->version == installedVersion) break;
-	}
-
-	return result;
-}
-
 void NativeResolverImpl::upgrade()
 {
-	for (const auto& item: __old_packages)
+	// the requests for all installed packages are added to the graph at once
+	p_upgradeRequested = true;
+	if (p_debugging)
 	{
-		const string& packageName = item.first;
-
-		RelationExpression notUpgradeExpression = getNotHigherThanInstalledPinRelationExpression(*__cache, packageName);
-		if (notUpgradeExpression.empty()) continue;
-
-		const string annotation = string("upgrade ") + packageName;
-		satisfyRelationExpression(notUpgradeExpression, true, annotation, RequestImportance::Wish, true);
+		debug2("on request 'upgrade' wishing to upgrade all installed packages");
 	}
 }
 
@@ -153,41 +146,138 @@ struct SolutionScoreLess
 	bool operator()(const shared_ptr< Solution >& left,
 			const shared_ptr< Solution >& right) const
 	{
-		if (left->getScore() < right->getScore())
+		auto leftScore = left->getScore() + left->estimate;
+		auto rightScore = right->getScore() + right->estimate;
+		if (leftScore < rightScore)
 		{
 			return true;
 		}
-		if (left->getScore() > right->getScore())
+		if (leftScore > rightScore)
 		{
 			return false;
 		}
 		return left->id > right->id;
 	}
 };
-typedef set< shared_ptr< Solution >, SolutionScoreLess > SolutionContainer;
-typedef std::function< SolutionContainer::iterator (SolutionContainer&) > SolutionChooser;
 
-SolutionContainer::iterator __fair_chooser(SolutionContainer& solutions)
+// the solutions pending processing, ordered by the resolver type
+class SolutionFrontier
 {
-	// choose the solution with maximum score
-	return --solutions.end();
-}
-
-SolutionContainer::iterator __full_chooser(SolutionContainer& solutions)
-{
-	// defer the decision until all solutions are built
-	FORIT(solutionIt, solutions)
+	typedef vector< shared_ptr< Solution > > Heap;
+
+	// 'fair': all solutions, the best one is on top
+	// 'full': only finished solutions, the best one is on top
+	Heap p_heap;
+	// 'full' only: unfinished solutions, the worst one is on top, so the
+	// decision is deferred until all solutions are built
+	Heap p_unfinishedHeap;
+	bool p_deferFinishing;
+	// after the search budget is exhausted: all solutions, ordered so that
+	// the best finished one is on top, then the children of the last popped
+	// solution, the best one on top, so the search dives to the nearest leaf
+	Heap p_stack;
+	size_t p_childrenStart;
+	bool p_diving;
+
+	static bool p_greater(const shared_ptr< Solution >& left, const shared_ptr< Solution >& right)
+	{
+		return SolutionScoreLess()(right, left);
+	}
+	static bool p_diveLess(const shared_ptr< Solution >& left, const shared_ptr< Solution >& right)
 	{
-		if (! (*solutionIt)->isFinished())
+		if (left->isFinished() != right->isFinished())
 		{
-			return solutionIt;
+			return right->isFinished();
 		}
+		return SolutionScoreLess()(left, right);
+	}
+	const Heap& p_getTopHeap() const
+	{
+		return p_unfinishedHeap.empty() ? p_heap : p_unfinishedHeap;
 	}
+ public:
+	SolutionFrontier(bool deferFinishing)
+		: p_deferFinishing(deferFinishing), p_childrenStart(0), p_diving(false)
+	{}
 
-	// heh, the whole solution tree has been already built?.. ok, let's choose
-	// the best solution
-	return __fair_chooser(solutions);
-}
+	bool empty() const
+	{
+		return p_heap.empty() && p_unfinishedHeap.empty() && p_stack.empty();
+	}
+	size_t size() const
+	{
+		return p_heap.size() + p_unfinishedHeap.size() + p_stack.size();
+	}
+	bool isDiving() const
+	{
+		return p_diving;
+	}
+	void startDiving()
+	{
+		p_stack = std::move(p_heap);
+		p_stack.insert(p_stack.end(), p_unfinishedHeap.begin(), p_unfinishedHeap.end());
+		p_heap.clear();
+		p_unfinishedHeap.clear();
+		std::sort(p_stack.begin(), p_stack.end(), p_diveLess);
+		p_childrenStart = p_stack.size();
+		p_diving = true;
+	}
+	void push(const shared_ptr< Solution >& solution)
+	{
+		if (p_diving)
+		{
+			auto position = std::upper_bound(p_stack.begin() + p_childrenStart, p_stack.end(), solution, p_diveLess);
+			p_stack.insert(position, solution);
+		}
+		else if (p_deferFinishing && !solution->isFinished())
+		{
+			p_unfinishedHeap.push_back(solution);
+			std::push_heap(p_unfinishedHeap.begin(), p_unfinishedHeap.end(), p_greater);
+		}
+		else
+		{
+			p_heap.push_back(solution);
+			std::push_heap(p_heap.begin(), p_heap.end(), SolutionScoreLess());
+		}
+	}
+	const shared_ptr< Solution >& top() const
+	{
+		return p_diving ? p_stack.back() : p_getTopHeap().front();
+	}
+	shared_ptr< Solution > pop()
+	{
+		shared_ptr< Solution > result;
+		if (p_diving)
+		{
+			result = std::move(p_stack.back());
+			p_stack.pop_back();
+			p_childrenStart = p_stack.size();
+		}
+		else if (!p_unfinishedHeap.empty())
+		{
+			std::pop_heap(p_unfinishedHeap.begin(), p_unfinishedHeap.end(), p_greater);
+			result = std::move(p_unfinishedHeap.back());
+			p_unfinishedHeap.pop_back();
+		}
+		else
+		{
+			std::pop_heap(p_heap.begin(), p_heap.end(), SolutionScoreLess());
+			result = std::move(p_heap.back());
+			p_heap.pop_back();
+		}
+		return result;
+	}
+	// the top levels of the heap, containing the solutions to be chosen soon
+	Range< Heap::const_iterator > getNearTop(size_t count) const
+	{
+		if (p_diving)
+		{
+			return { p_stack.end() - std::min(count, p_stack.size()), p_stack.end() };
+		}
+		const auto& heap = p_getTopHeap();
+		return { heap.begin(), heap.begin() + std::min(count, heap.size()) };
+	}
+};
 
 bool NativeResolverImpl::p_computeTargetAutoStatus(const string& packageName,
 		const PreparedSolution& solution, dg::Element element) const
@@ -220,7 +310,7 @@ AutoRemovalPossibility::Allow NativeResolverImpl::p_isCandidateForAutoRemoval(
 {
 	typedef AutoRemovalPossibility::Allow Allow;
 
-	auto versionVertex = dynamic_cast< const dg::VersionVertex* >(element);
+	auto versionVertex = element->asVersion();
 	if (!versionVertex)
 	{
 		return Allow::No;
@@ -234,119 +324,114 @@ AutoRemovalPossibility::Allow NativeResolverImpl::p_isCandidateForAutoRemoval(
 		return Allow::No;
 	}
 
-	return __auto_removal_possibility.isAllowed(version, __old_packages.count(packageName),
+	if (auto cached = p_autoRemovalCandidacies.get(element))
+	{
+		return Allow(cached - 1);
+	}
+
+	bool isOld = __old_packages.count(packageName);
+	auto result = __auto_removal_possibility.isAllowed(version, isOld,
 			p_computeTargetAutoStatus(packageName, solution, element));
+	// only the auto status of new packages depends on the solution
+	if (isOld || __auto_status_overrides.count(packageName))
+	{
+		p_autoRemovalCandidacies[element] = uint8_t(result) + 1;
+	}
+	return result;
 }
 
 bool NativeResolverImpl::__clean_automatically_installed(PreparedSolution& solution)
 {
 	typedef AutoRemovalPossibility::Allow Allow;
+	PhaseTimer timer(p_statistics.autoRemovalTime);
+
+	struct Mark
+	{
+		Allow allow;
+		bool reached;
+	};
+	auto entries = solution.getEntries();
+	unordered_map< dg::Element, Mark > marks(entries.size());
+	for (auto packageEntry: entries)
+	{
+		auto element = packageEntry->element;
+		marks.insert({ element, { p_isCandidateForAutoRemoval(solution, element), false } });
+	}
 
-	map< dg::Element, Allow > isCandidateForAutoRemovalCache;
-	auto isCandidateForAutoRemoval = [this, &solution, &isCandidateForAutoRemovalCache]
-			(dg::Element element) -> Allow
+	// walking from the elements which cannot be auto-removed; the supports
+	// of an element are looked at only once it is reached
+	vector< dg::Element > queue;
+	typedef decltype(marks)::value_type MarkedElement;
+	auto reach = [&queue](MarkedElement& item)
 	{
-		auto cacheInsertionResult = isCandidateForAutoRemovalCache.insert( { element, {}});
-		auto& answer = cacheInsertionResult.first->second;
-		if (cacheInsertionResult.second)
+		if (!item.second.reached)
 		{
-			answer = p_isCandidateForAutoRemoval(solution, element);
+			item.second.reached = true;
+			queue.push_back(item.first);
 		}
-		return answer;
 	};
-
-	Graph<dg::Element> dependencyGraph;
-	auto mainVertexPtr = dependencyGraph.addVertex(nullptr);
-	const set<dg::Element>& vertices = dependencyGraph.getVertices();
-	{ // building dependency graph
-		for (auto packageEntry: solution.getEntries())
+	for (auto& item: marks)
+	{
+		if (item.second.allow == Allow::No)
 		{
-			dependencyGraph.addVertex(packageEntry->element);
+			reach(item);
 		}
-		for (const auto& element: vertices)
+	}
+	while (!queue.empty())
+	{
+		auto element = queue.back();
+		queue.pop_back();
+
+		for (auto successorElement: __solution_storage->getSuccessorElements(element))
 		{
-			if (!element) continue; // main vertex
+			if (successorElement->isAnti()) continue;
 
-			for (auto successorElement: __solution_storage->getSuccessorElements(element))
+			bool allRightSidesAreAutomatic = true;
+			MarkedElement* candidate = nullptr;
+			for (auto successorSuccessorElement: __solution_storage->getSuccessorElements(successorElement))
 			{
-				if (successorElement->isAnti()) continue;
-
-				bool allRightSidesAreAutomatic = true;
-				const dg::Element* candidateElementPtr = nullptr;
-				for (auto successorSuccessorElement: __solution_storage->getSuccessorElements(successorElement))
+				auto it = marks.find(successorSuccessorElement);
+				if (it != marks.end())
 				{
-					auto it = vertices.find(successorSuccessorElement);
-					if (it != vertices.end())
+					switch (it->second.allow)
 					{
-						switch (isCandidateForAutoRemoval(*it))
-						{
-							case Allow::No:
-								allRightSidesAreAutomatic = false;
-								break;
-							case Allow::YesIfNoRDepends:
-								dependencyGraph.addEdge(&element, &*it);
-							case Allow::Yes:
-								if (!candidateElementPtr) // not found yet
-								{
-									candidateElementPtr = &*it;
-								}
-								break;
-						}
+						case Allow::No:
+							allRightSidesAreAutomatic = false;
+							break;
+						case Allow::YesIfNoRDepends:
+							reach(*it);
+							// fallthrough
+						case Allow::Yes:
+							if (!candidate) // not found yet
+							{
+								candidate = &*it;
+							}
+							break;
 					}
 				}
-				if (allRightSidesAreAutomatic && candidateElementPtr)
-				{
-					dependencyGraph.addEdge(&element, candidateElementPtr);
-				}
 			}
-
-			if (isCandidateForAutoRemoval(element) == Allow::No)
+			if (allRightSidesAreAutomatic && candidate)
 			{
-				dependencyGraph.addEdge(mainVertexPtr, &element);
+				reach(*candidate);
 			}
 		}
 	}
 
-	{ // looping through the candidates
-		auto reachableElementPtrs = dependencyGraph.getReachableFrom(*mainVertexPtr);
-
-		for (const auto& element: vertices)
+	for (auto packageEntry: entries)
+	{
+		auto element = packageEntry->element;
+		if (!marks[element].reached)
 		{
-			if (!reachableElementPtrs.count(&element))
+			__solution_storage->setEmpty(solution, element);
+			if (p_debugging)
 			{
-				__solution_storage->setEmpty(solution, element);
-				if (p_debugging)
-				{
-					__mydebug_wrapper(solution, "auto-removed '%s'", element->toString());
-				}
-
+				__mydebug_wrapper(solution, "auto-removed '%s'", element->toString());
 			}
 		}
 	}
 	return true;
 }
 
-SolutionChooser __select_solution_chooser(const Config& config)
-{
-	SolutionChooser result;
-
-	auto resolverType = config.getString("cupt::resolver::type");
-	if (resolverType == "fair")
-	{
-		result = __fair_chooser;
-	}
-	else if (resolverType == "full")
-	{
-		result = __full_chooser;
-	}
-	else
-	{
-		fatal2(__("wrong resolver type '%s'"), resolverType);
-	}
-
-	return result;
-}
-
 /* __pre_apply_action only prints debug info and changes level/score of the
    solution, not necessarily modifying packages in it, saving RAM and CPU */
 void NativeResolverImpl::__pre_apply_action(const Solution& originalSolution,
@@ -379,7 +464,7 @@ ScoreChange NativeResolverImpl::p_getScoreChange(
 {
 	auto getVersion = [](dg::Element element) -> const BinaryVersion*
 	{
-		auto versionVertex = dynamic_cast< const dg::VersionVertex* >(element);
+		auto versionVertex = element->asVersion();
 		if (!versionVertex)
 		{
 			return nullptr;
@@ -387,12 +472,28 @@ ScoreChange NativeResolverImpl::p_getScoreChange(
 		return versionVertex->version;
 	};
 
+	auto getPin = [this](dg::Element element, const BinaryVersion* version) -> ssize_t
+	{
+		if (!version) return 0;
+		auto& pin = p_versionPins[element];
+		if (pin == std::numeric_limits< ssize_t >::min())
+		{
+			pin = __score_manager.getVersionPin(version);
+		}
+		return pin;
+	};
+
 	ScoreChange result;
 	switch (newElement->getUnsatisfiedType())
 	{
 		case dg::Unsatisfied::None:
-			result = __score_manager.getVersionScoreChange(getVersion(oldElement), getVersion(newElement));
+		{
+			auto oldVersion = getVersion(oldElement);
+			auto newVersion = getVersion(newElement);
+			result = __score_manager.getVersionScoreChange(oldVersion, getPin(oldElement, oldVersion),
+					newVersion, getPin(newElement, newVersion));
 			break;
+		}
 		case dg::Unsatisfied::Recommends:
 			result = __score_manager.getUnsatisfiedRecommendsScoreChange();
 			break;
@@ -426,17 +527,80 @@ void NativeResolverImpl::__pre_apply_actions_to_solution_tree(
 	// apply all the solutions by one
 	bool onlyOneAction = (actions.size() == 1);
 	auto oldSolutionId = currentSolution->id;
+	auto oldScore = currentSolution->getScore();
 	size_t position = 0;
+
+	// the children keep the problems of the parent except the one being fixed
+	dg::Element brokenElement = nullptr;
+	ssize_t childEstimate = 0;
+	ssize_t bestScoreChange = std::numeric_limits< ssize_t >::min();
+	if (p_estimating)
+	{
+		brokenElement = actions.front()->introducedBy.brokenElementPtr;
+		auto topFixPenalties = p_getTopFixPenalties(*currentSolution);
+		childEstimate = -(topFixPenalties.element == brokenElement ?
+				topFixPenalties.second : topFixPenalties.largest);
+	}
+
 	for (auto& action: actions)
 	{
 		auto newSolution = onlyOneAction ?
 				__solution_storage->fakeCloneSolution(currentSolution) :
 				__solution_storage->cloneSolution(currentSolution);
-		checkLeafLimit(newSolution->id, p_maxLeafCount);
+		if (!p_anytime)
+		{
+			checkLeafLimit(newSolution->id, p_maxLeafCount);
+		}
 		__pre_apply_action(*currentSolution, *newSolution,
 				std::move(action), position++, oldSolutionId);
+		if (p_estimating)
+		{
+			bestScoreChange = std::max(bestScoreChange, newSolution->getScore() - oldScore);
+			newSolution->estimate = childEstimate;
+		}
 		callback(newSolution);
 	}
+
+	if (p_estimating)
+	{
+		p_learnFixPenalty(brokenElement, bestScoreChange);
+	}
+}
+
+auto NativeResolverImpl::p_getTopFixPenalties(const PreparedSolution& solution) const -> TopFixPenalties
+{
+	TopFixPenalties result = { nullptr, 0, 0 };
+	solution.foreachBrokenSuccessor([this, &result](const BrokenSuccessor& bs)
+	{
+		auto penalty = p_fixPenalties.get(bs.elementPtr);
+		if (penalty < 0) return; // not seen yet, may be free
+
+		if (penalty > result.largest)
+		{
+			result.second = result.largest;
+			result.largest = penalty;
+			result.element = bs.elementPtr;
+		}
+		else if (penalty > result.second)
+		{
+			result.second = penalty;
+		}
+	});
+	return result;
+}
+
+/* the penalty of fixing an element is the loss of the best of its actions;
+   it depends on the solution, and the lowest one seen so far is kept, which
+   still may overestimate it for other solutions: the estimate is a
+   heuristic, not a lower bound, so the search is no admissible A* */
+void NativeResolverImpl::p_learnFixPenalty(dg::Element brokenElement, ssize_t bestScoreChange)
+{
+	auto penalty = std::max< ssize_t >(0, -bestScoreChange);
+	auto& knownPenalty = p_fixPenalties[brokenElement];
+	if (knownPenalty < 0 || knownPenalty > penalty)
+	{
+		knownPenalty = penalty;
+	}
 }
 
 static bool isRelationMoreWide(const SolutionStorage& solutionStorage, const PreparedSolution& solution,
@@ -556,13 +720,32 @@ void NativeResolverImpl::__prepare_reject_requests(vector< unique_ptr< Action >
 {
 	if (actions.size() <= 1) return;
 
-	auto allNewElements = std::make_shared< vector<dg::Element> >();
-	allNewElements->reserve(actions.size());
+	auto alternatives = allocateShared< ActionAlternatives >(__solution_storage->getArena());
+	auto& elements = alternatives->elements;
+	elements.reserve(actions.size());
+	alternatives->familyHeads.reserve(actions.size());
+	alternatives->nextFamilyMembers.assign(actions.size(), actions.size());
 
+	unordered_map< dg::Element, uint32_t > lastFamilyMembers;
 	for (const auto& action: actions)
 	{
-		action->allActionNewElements = allNewElements;
-		allNewElements->push_back(action->newElementPtr);
+		uint32_t position = elements.size();
+		action->alternatives = alternatives;
+		action->alternativePosition = position;
+		elements.push_back(action->newElementPtr);
+
+		auto insertResult = lastFamilyMembers.insert({ action->newElementPtr->getFamilyKey(), position });
+		if (insertResult.second)
+		{
+			alternatives->familyHeads.push_back(position);
+		}
+		else
+		{
+			auto& lastMember = insertResult.first->second;
+			alternatives->familyHeads.push_back(alternatives->familyHeads[lastMember]);
+			alternatives->nextFamilyMembers[lastMember] = position;
+			lastMember = position;
+		}
 	}
 }
 
@@ -601,7 +784,7 @@ void NativeResolverImpl::__fillSuggestedPackageReasons(const PreparedSolution& s
 		const auto& introducedBy = packageEntryPtr->introducedBy;
 		if (!introducedBy.empty())
 		{
-			suggestedPackage.reasons.push_back(introducedBy.getReason());
+			suggestedPackage.reasons.push_back(__solution_storage->getReason(introducedBy));
 			__solution_storage->processReasonElements(solution,
 					introducedBy, element, std::cref(fillReasonElements));
 		} else if (element->version) {
@@ -616,6 +799,9 @@ void NativeResolverImpl::__fillSuggestedPackageReasons(const PreparedSolution& s
 Resolver::UserAnswer::Type NativeResolverImpl::__propose_solution(
 		const PreparedSolution& solution, Resolver::CallbackType callback, bool trackReasons)
 {
+	PhaseTimer timer(p_statistics.proposalTime);
+	++p_statistics.proposedSolutions;
+
 	// build "user-frienly" version of solution
 	Resolver::Offer offer;
 	Resolver::SuggestedPackages& suggestedPackages = offer.suggestedPackages;
@@ -624,7 +810,7 @@ Resolver::UserAnswer::Type NativeResolverImpl::__propose_solution(
 	{
 		auto elementPtr = packageEntry->element;
 
-		auto vertex = dynamic_cast<dg::VersionElement>(elementPtr);
+		auto vertex = elementPtr->asVersion();
 		if (vertex)
 		{
 			const string& packageName = vertex->getPackageName();
@@ -651,8 +837,10 @@ Resolver::UserAnswer::Type NativeResolverImpl::__propose_solution(
 				{
 					if (solution.getPackageEntry(affectedVersionElementPtr))
 					{
-						offer.unresolvedProblems.push_back(
-								predecessor->getReason(*affectedVersionElementPtr));
+						IntroducedBy problem;
+						problem.versionElementPtr = affectedVersionElementPtr;
+						problem.brokenElementPtr = predecessor;
+						offer.unresolvedProblems.push_back(__solution_storage->getReason(problem));
 					}
 				}
 			}
@@ -662,10 +850,14 @@ Resolver::UserAnswer::Type NativeResolverImpl::__propose_solution(
 	// suggest found solution
 	if (p_debugging)
 	{
-		__mydebug_wrapper(solution, "proposing this solution");
+		__mydebug_wrapper(solution, "proposing this solution, final score %zd", p_getFinalScore(solution));
 	}
 
 	auto userAnswer = callback(offer);
+	if (userAnswer == Resolver::UserAnswer::Accept && p_solutionCache && p_solutionCache->isEnabled())
+	{
+		p_solutionCache->store(p_getCachedSolution(solution));
+	}
 	if (p_debugging)
 	{
 		if (userAnswer == Resolver::UserAnswer::Accept)
@@ -681,6 +873,32 @@ Resolver::UserAnswer::Type NativeResolverImpl::__propose_solution(
 	return userAnswer;
 }
 
+// unlike the solution score, counts only the final changes against the
+// original system, and without the quality adjustment of the search
+ssize_t NativeResolverImpl::p_getFinalScore(const PreparedSolution& solution) const
+{
+	ssize_t result = 0;
+	for (auto packageEntry: solution.getEntries())
+	{
+		auto element = packageEntry->element;
+		if (auto vertex = element->asVersion())
+		{
+			auto oldPackageIt = __old_packages.find(vertex->getPackageName());
+			auto oldVersion = (oldPackageIt != __old_packages.end()) ? oldPackageIt->second : nullptr;
+			if (vertex->version == oldVersion) continue;
+
+			result += __score_manager.getScoreChangeValue(
+					__score_manager.getVersionScoreChange(oldVersion, vertex->version));
+		}
+		else
+		{
+			result += __score_manager.getScoreChangeValue(p_getScoreChange(nullptr, element, 0));
+		}
+		result -= __score_manager.qualityAdjustment;
+	}
+	return result;
+}
+
 struct BrokenPair
 {
 	dg::Element versionElement;
@@ -704,6 +922,7 @@ void NativeResolverImpl::__generate_possible_actions(vector< unique_ptr< Action
 
 void NativeResolverImpl::__final_verify_solution(const PreparedSolution& solution)
 {
+	PhaseTimer timer(p_statistics.verificationTime);
 	for (auto packageEntry: solution.getEntries())
 	{
 		auto element = packageEntry->element;
@@ -719,50 +938,27 @@ void NativeResolverImpl::__final_verify_solution(const PreparedSolution& solutio
 }
 
 BrokenPair __get_broken_pair(const SolutionStorage& solutionStorage,
-		const PreparedSolution& solution, const map< dg::Element, size_t >& failCounts)
+		const PreparedSolution& solution, const dg::ElementTable< size_t >& failCounts)
 {
 	auto failValue = [&failCounts](dg::Element e) -> size_t
 	{
-		auto it = failCounts.find(e);
-		return it != failCounts.end() ? it->second : 0u;
+		return failCounts.get(e);
 	};
-	auto compareBrokenSuccessors = [&failValue](const BrokenSuccessor& left, const BrokenSuccessor& right)
+	// the most important problem is the one of the highest type priority, then
+	// of the highest priority, then the one failed most times, then the newest
+	BrokenPair result = { nullptr, { nullptr, 0, 0 } };
+	size_t resultFailValue = 0;
+	solution.foreachTopBrokenSuccessor([&result, &resultFailValue, &failValue](const BrokenSuccessor& bs)
 	{
-		auto leftTypePriority = left.elementPtr->getTypePriority();
-		auto rightTypePriority = right.elementPtr->getTypePriority();
-		if (leftTypePriority < rightTypePriority)
-		{
-			return true;
-		}
-		if (leftTypePriority > rightTypePriority)
+		auto bsFailValue = failValue(bs.elementPtr);
+		const auto& best = result.brokenSuccessor;
+		if (!best.elementPtr || bsFailValue > resultFailValue ||
+				(bsFailValue == resultFailValue && bs.elementPtr->id > best.elementPtr->id))
 		{
-			return false;
-		}
-
-		if (left.priority < right.priority)
-		{
-			return true;
-		}
-		if (left.priority > right.priority)
-		{
-			return false;
-		}
-
-		auto leftFailValue = failValue(left.elementPtr);
-		auto rightFailValue = failValue(right.elementPtr);
-		if (leftFailValue < rightFailValue)
-		{
-			return true;
-		}
-		if (leftFailValue > rightFailValue)
-		{
-			return false;
+			result.brokenSuccessor = bs;
+			resultFailValue = bsFailValue;
 		}
-
-		return left.elementPtr->id < right.elementPtr->id;
-	};
-
-	BrokenPair result = { nullptr, solution.getMaxBrokenSuccessor(compareBrokenSuccessors) };
+	});
 
 	if (result.brokenSuccessor.elementPtr)
 	{
@@ -786,14 +982,20 @@ BrokenPair __get_broken_pair(const SolutionStorage& solutionStorage,
 	return result;
 }
 
-shared_ptr< PreparedSolution > __get_next_current_solution(
-		SolutionContainer& solutions, SolutionStorage& solutionStorage, const SolutionChooser& chooser)
+// collects the solutions which are likely to be chosen in the next iterations
+static vector< shared_ptr< Solution > > __get_speculation_candidates(
+		const SolutionFrontier& solutions, const SolutionStorage& solutionStorage, size_t maxCount)
 {
-	auto currentSolutionIt = chooser(solutions);
-	shared_ptr< Solution > currentSolution = *currentSolutionIt;
-	solutions.erase(currentSolutionIt);
-
-	return solutionStorage.prepareSolution(currentSolution);
+	vector< shared_ptr< Solution > > result;
+	for (const auto& solution: solutions.getNearTop(maxCount*4))
+	{
+		if (result.size() == maxCount) break;
+		if (solutionStorage.isSpeculativelyPreparable(*solution))
+		{
+			result.push_back(solution);
+		}
+	}
+	return result;
 }
 
 void NativeResolverImpl::__fill_and_process_introduced_by(
@@ -803,9 +1005,13 @@ void NativeResolverImpl::__fill_and_process_introduced_by(
 	ourIntroducedBy.versionElementPtr = bp.versionElement;
 	ourIntroducedBy.brokenElementPtr = bp.brokenSuccessor.elementPtr;
 
-	if (actionsPtr->empty() && !__any_solution_was_found)
+	if (actionsPtr->empty())
 	{
-		__decision_fail_tree.addFailedSolution(*__solution_storage, solution, ourIntroducedBy);
+		p_learnNogood(solution, bp);
+		if (!__any_solution_was_found)
+		{
+			__decision_fail_tree.addFailedSolution(*__solution_storage, solution, ourIntroducedBy);
+		}
 	}
 	else
 	{
@@ -816,6 +1022,70 @@ void NativeResolverImpl::__fill_and_process_introduced_by(
 	}
 }
 
+/* of the failure, only the sticked package entries are remembered: the
+   broken element can be neither fixed by changing its version nor satisfied
+   because the families of all its successors are sticked to other members */
+void NativeResolverImpl::p_learnNogood(const PreparedSolution& solution, const BrokenPair& bp)
+{
+	if (!solution.getPackageEntry(bp.versionElement)->sticked)
+	{
+		return;
+	}
+
+	vector< dg::Element > elements = { bp.versionElement };
+	for (auto successor: __solution_storage->getSuccessorElements(bp.brokenSuccessor.elementPtr))
+	{
+		dg::Element conflictingElement;
+		if (__solution_storage->simulateSetPackageEntry(solution, successor, &conflictingElement))
+		{
+			return;
+		}
+		auto conflictingEntry = solution.getPackageEntry(conflictingElement);
+		if (!conflictingEntry || !conflictingEntry->sticked)
+		{
+			return; // rejected, which doesn't survive the change of the entry
+		}
+		elements.push_back(conflictingElement);
+	}
+
+	if (p_debugging)
+	{
+		__mydebug_wrapper(solution, "learning a nogood of %zu elements from the problem %s",
+				elements.size(), bp.brokenSuccessor.elementPtr->toString());
+	}
+	p_nogoods.add(std::move(elements));
+}
+
+void NativeResolverImpl::p_dropActionsHittingNogoods(
+		const PreparedSolution& solution, ActionContainer* actionsPtr)
+{
+	auto& actions = *actionsPtr;
+	if (actions.empty()) return;
+	auto introducedBy = actions.front()->introducedBy;
+
+	auto hitsNogood = [this, &solution](const unique_ptr< Action >& action)
+	{
+		// a non-sticked entry can still be changed later
+		if (!action->brokenElementPriority) return false;
+
+		if (!p_nogoods.isHitBy(solution, action->newElementPtr)) return false;
+
+		if (p_debugging)
+		{
+			__mydebug_wrapper(solution, "not considering %s: it leads to a known dead end",
+					action->newElementPtr->toString());
+		}
+		return true;
+	};
+	actions.erase(std::remove_if(actions.begin(), actions.end(), hitsNogood), actions.end());
+
+	// the nogoods outlive the fail tree, so the dead end is recorded as a direct one
+	if (actions.empty() && !__any_solution_was_found)
+	{
+		__decision_fail_tree.addFailedSolution(*__solution_storage, solution, introducedBy);
+	}
+}
+
 static void increaseQualityAdjustment(ssize_t* qa)
 {
 	const float factor = 1.45f;
@@ -824,32 +1094,196 @@ static void increaseQualityAdjustment(ssize_t* qa)
 	*qa *= factor;
 }
 
-bool NativeResolverImpl::resolve(Resolver::CallbackType callback)
+void NativeResolverImpl::p_printStatistics(ResolverStatistics::Clock::time_point startTime)
 {
-	auto initialSolution = std::make_shared< PreparedSolution >();
-	__solution_storage.reset(new SolutionStorage(*__config, *__cache));
-	__solution_storage->prepareForResolving(*initialSolution, __old_packages, p_userRelationExpressions);
+	if (!__config->getBool("debug::resolver::statistics")) return;
+
+	p_statistics.totalTime = ResolverStatistics::Clock::now() - startTime;
+	__solution_storage->addStatistics(&p_statistics);
+	p_statistics.print();
+}
+
+static double toSeconds(ResolverStatistics::Clock::duration duration)
+{
+	return std::chrono::duration< double >(duration).count();
+}
+
+bool NativeResolverImpl::p_isSearchBudgetExhausted() const
+{
+	if (!p_anytime || p_searchBudgetExhausted) return false;
+
+	return __solution_storage->getCreatedSolutionCount() > p_maxLeafCount ||
+			ResolverStatistics::Clock::now() > p_deadline;
+}
 
+/* stops branching: the best finished solution, if any, is proposed next,
+   otherwise the most promising unfinished one is completed by always taking
+   its best child, backtracking only on dead ends */
+void NativeResolverImpl::p_exhaustSearchBudget(SolutionFrontier& solutions)
+{
+	p_searchBudgetExhausted = true;
+	++p_statistics.searchBudgetExhaustions;
+
+	auto now = ResolverStatistics::Clock::now();
+	warn2(__("the resolver has exhausted its search budget after %.1f seconds and %zu solutions, taking the best solution found so far"),
+			toSeconds(now - p_searchStartTime), __solution_storage->getCreatedSolutionCount());
+	solutions.startDiving();
+
+	p_completionSteps = 0;
+	p_deadline = now + (p_deadline - p_searchStartTime);
+}
+
+void NativeResolverImpl::p_checkCompletionBudget()
+{
+	if (++p_completionSteps > 2 * p_maxLeafCount || ResolverStatistics::Clock::now() > p_deadline)
+	{
+		fatal2(__("the resolver has exhausted its search budget while completing a solution"));
+	}
+}
+
+auto NativeResolverImpl::p_resolveByTree(const shared_ptr<PreparedSolution>& initialSolution, Resolver::CallbackType callback) -> Resolve2Result
+{
 	auto& sqa = __score_manager.qualityAdjustment;
-	sqa = __config->getInteger("cupt::resolver::score::quality-adjustment");
 
-	Resolve2Result subresult;
-	while ((subresult = p_resolve2(initialSolution, callback)) == Resolve2Result::HitSolutionTreeLimit)
+	Resolve2Result result;
+	while ((result = p_resolve2(initialSolution, callback)) == Resolve2Result::HitSolutionTreeLimit)
 	{
 		if (p_debugging) debug2("hit solution tree limit, old quality adjustment '%zd'", sqa);
 		increaseQualityAdjustment(&sqa);
+		++p_statistics.restarts;
 		if (p_debugging) debug2("restarting with quality adjustment '%zd'", sqa);
 	}
+	return result;
+}
+
+bool NativeResolverImpl::resolve(Resolver::CallbackType callback)
+{
+	auto resolverType = __config->getString("cupt::resolver::type");
+	if (resolverType != "fair" && resolverType != "full" && resolverType != "sat" && resolverType != "estimated")
+	{
+		fatal2(__("wrong resolver type '%s'"), resolverType);
+	}
+
+	p_statistics = ResolverStatistics();
+	auto startTime = ResolverStatistics::Clock::now();
+
+	auto timeLimit = __config->getInteger("cupt::resolver::time-limit");
+	p_anytime = (timeLimit > 0);
+	p_searchBudgetExhausted = false;
+	p_searchStartTime = startTime;
+	p_deadline = startTime + std::chrono::seconds(timeLimit);
+
+	// the graph of the installability checks is replaced
+	p_installabilityCheckBase.reset();
+	p_nogoods.clear();
+
+	auto initialSolution = std::make_shared< PreparedSolution >();
+	p_resetSolutionStorage();
+	{
+		PhaseTimer timer(p_statistics.graphFillTime);
+		__solution_storage->prepareForResolving(*initialSolution, __old_packages,
+				p_userRelationExpressions, p_upgradeRequested);
+	}
+
+	__score_manager.qualityAdjustment = __config->getInteger("cupt::resolver::score::quality-adjustment");
+
+	p_solutionCache.reset(new SolutionCache(*__config, *__cache,
+			__old_packages, __auto_status_overrides, p_userRelationExpressions, p_upgradeRequested));
+
+	Resolve2Result subresult;
+	try
+	{
+		if (p_proposeCachedSolution(initialSolution, callback, &subresult))
+		{
+			; // answered
+		}
+		else if (resolverType == "sat")
+		{
+			subresult = p_resolveBySat(initialSolution, callback);
+		}
+		else
+		{
+			subresult = p_resolveByTree(initialSolution, callback);
+			if (!__any_solution_was_found)
+			{
+				// no solutions pending, we have a great fail
+				fatal2(__("unable to resolve dependencies, because of:\n\n%s"),
+						__decision_fail_tree.toString(*__solution_storage));
+			}
+		}
+	}
+	catch (...)
+	{
+		// failed resolvings are no less interesting
+		p_printStatistics(startTime);
+		p_graphCache.store();
+		throw;
+	}
+	p_printStatistics(startTime);
+	p_graphCache.store();
+
+	if (p_debugging)
+	{
+		debug2("the solution arena has grown to %zu bytes", __solution_storage->getArena().getAllocatedSize());
+		debug2("%zu nogoods were learned", p_nogoods.size());
+	}
+	// they refer to the elements of the dependency graph being released
+	p_nogoods.clear();
+	p_autoRemovalCandidacies.clear();
+	// no solutions are alive anymore, release all their memory at once
+	initialSolution.reset();
+	__solution_storage.reset();
 
 	return subresult == Resolve2Result::Yes;
 }
 
-auto NativeResolverImpl::p_resolve2(const shared_ptr<PreparedSolution>& initialSolution, Resolver::CallbackType callback) -> Resolve2Result
+/* unlike resolve(), uses the tree search whatever the resolver type is, as
+   only the existence of a solution matters; the graph, the package entries
+   of the system state and the learned nogoods are kept between the checks */
+bool NativeResolverImpl::checkInstallability(const BinaryVersion* version, string* failureReason)
 {
-	auto solutionChooser = __select_solution_chooser(*__config);
+	p_solutionCache.reset(); // only the solutions of resolve() are cached
+
+	if (!p_installabilityCheckBase)
+	{
+		p_resetSolutionStorage();
+		p_installabilityCheckBase = std::make_shared< PreparedSolution >();
+		__solution_storage->prepareForResolving(*p_installabilityCheckBase, __old_packages, {}, false);
+	}
+
+	const string& packageName = version->packageName;
+	Relation relation({ packageName.data(), packageName.data()+packageName.size() });
+	relation.relationType = Relation::Types::LiteralyEqual;
+	relation.versionString = version->versionString;
+	RelationExpression expression;
+	expression.push_back(relation);
+	dg::UserRelationExpression request = { expression, false,
+			format2("install %s %s", packageName, version->versionString), RequestImportance::Must, false };
+	if (p_debugging)
+	{
+		debug2("checking installability of '%s %s'", packageName, version->versionString);
+	}
+
+	p_anytime = false;
+	auto initialSolution = std::make_shared< PreparedSolution >();
+	initialSolution->initEntriesFromParent(*p_installabilityCheckBase);
+	__solution_storage->insertRequestsElement(*initialSolution, __solution_storage->addIndependentRequests({ request }));
+
+	__score_manager.qualityAdjustment = __config->getInteger("cupt::resolver::score::quality-adjustment");
+	auto acceptFirst = [](const Resolver::Offer&) { return Resolver::UserAnswer::Accept; };
+	if (p_resolveByTree(initialSolution, acceptFirst) == Resolve2Result::Yes)
+	{
+		return true;
+	}
+	*failureReason = __decision_fail_tree.toString(*__solution_storage);
+	return false;
+}
 
+auto NativeResolverImpl::p_resolve2(const shared_ptr<PreparedSolution>& initialSolution, Resolver::CallbackType callback) -> Resolve2Result
+{
 	const bool trackReasons = __config->getBool("cupt::resolver::track-reasons");
 	const size_t maxSolutionCount = __config->getInteger("cupt::resolver::max-solution-count");
+	const bool dropDuplicates = __config->getBool("cupt::resolver::drop-duplicate-solutions");
 	p_maxLeafCount = __config->getInteger("cupt::resolver::max-leaf-count");
 
 	if (p_debugging) debug2("started resolving");
@@ -857,20 +1291,70 @@ auto NativeResolverImpl::p_resolve2(const shared_ptr<PreparedSolution>& initialS
 	__any_solution_was_found = false;
 	__decision_fail_tree.clear();
 
-	SolutionContainer solutions = { initialSolution };
+	auto resolverType = __config->getString("cupt::resolver::type");
+	SolutionFrontier solutions(resolverType == "full");
+	p_estimating = (resolverType == "estimated");
+	p_fixPenalties.clear();
+	initialSolution->estimate = 0;
+	solutions.push(initialSolution);
+
+	const size_t threadCount = __config->getInteger("cupt::resolver::threads");
+	unique_ptr< SpeculativePreparer > speculativePreparer;
+	if (threadCount > 1)
+	{
+		speculativePreparer.reset(new SpeculativePreparer(*__solution_storage, threadCount));
+	}
 
 	// for each package entry 'count' will contain the number of failures
 	// during processing these packages
-	map< dg::Element, size_t > failCounts;
+	dg::ElementTable< size_t > failCounts(__solution_storage->getFirstElementId());
+
+	// different orders of the same actions lead to the same solutions, only
+	// the best scored of them is kept
+	unordered_map< uint64_t, ssize_t > seenScores;
 
 	while (!solutions.empty())
 	{
 		vector< unique_ptr< Action > > possibleActions;
 
-		auto currentSolution = __get_next_current_solution(solutions, *__solution_storage, solutionChooser);
+		if (p_isSearchBudgetExhausted())
+		{
+			p_exhaustSearchBudget(solutions);
+		}
+		else if (p_searchBudgetExhausted)
+		{
+			p_checkCompletionBudget();
+		}
+
+		if (speculativePreparer)
+		{
+			auto candidates = __get_speculation_candidates(solutions, *__solution_storage, threadCount);
+			if (candidates.size() > 1)
+			{
+				speculativePreparer->prepare(candidates);
+			}
+		}
+
+		auto currentSolution = __solution_storage->prepareSolution(solutions.pop());
+		if (p_estimating)
+		{
+			// the estimate of the parent didn't know the effects of the action
+			auto estimate = -p_getTopFixPenalties(*currentSolution).largest;
+			if (estimate != currentSolution->estimate)
+			{
+				currentSolution->estimate = estimate;
+				solutions.push(currentSolution);
+				if (solutions.top() != currentSolution)
+				{
+					continue; // ok, process other solution
+				}
+				solutions.pop();
+			}
+		}
 
 		auto problemFound = [this, &failCounts, &possibleActions, &currentSolution]
 		{
+			++p_statistics.brokenPairLookups;
 			auto bp = __get_broken_pair(*__solution_storage, *currentSolution, failCounts);
 			if (!bp.versionElement) return false;
 
@@ -881,6 +1365,7 @@ auto NativeResolverImpl::p_resolve2(const shared_ptr<PreparedSolution>& initialS
 						bp.versionElement->toString(), bp.brokenSuccessor.elementPtr->toString());
 			}
 			__generate_possible_actions(&possibleActions, *currentSolution, bp);
+			p_statistics.addStep(possibleActions.size());
 			__fill_and_process_introduced_by(*currentSolution, bp, &possibleActions);
 
 			// mark package as failed one more time
@@ -902,13 +1387,12 @@ auto NativeResolverImpl::p_resolve2(const shared_ptr<PreparedSolution>& initialS
 			}
 
 			// resolver can refuse the solution
-			solutions.insert(currentSolution);
-			auto newSelectedSolutionIt = solutionChooser(solutions);
-			if (*newSelectedSolutionIt != currentSolution)
+			solutions.push(currentSolution);
+			if (solutions.top() != currentSolution)
 			{
 				continue; // ok, process other solution
 			}
-			solutions.erase(newSelectedSolutionIt);
+			solutions.pop();
 
 			// clean up automatically installed by resolver and now unneeded packages
 			if (!__clean_automatically_installed(*currentSolution))
@@ -917,6 +1401,7 @@ auto NativeResolverImpl::p_resolve2(const shared_ptr<PreparedSolution>& initialS
 				{
 					__mydebug_wrapper(*currentSolution, "auto-discarded");
 				}
+				++p_statistics.discardedSolutions;
 				continue;
 			}
 
@@ -928,6 +1413,11 @@ auto NativeResolverImpl::p_resolve2(const shared_ptr<PreparedSolution>& initialS
 
 			__final_verify_solution(*currentSolution);
 
+			if (p_anytime && p_debugging)
+			{
+				debug2("remaining search budget: %.3f seconds",
+						toSeconds(p_deadline - ResolverStatistics::Clock::now()));
+			}
 			auto userAnswer = __propose_solution(*currentSolution, callback, trackReasons);
 			switch (userAnswer)
 			{
@@ -944,6 +1434,9 @@ auto NativeResolverImpl::p_resolve2(const shared_ptr<PreparedSolution>& initialS
 		else
 		{
 			__prepare_reject_requests(possibleActions);
+			auto actionCount = possibleActions.size();
+			p_dropActionsHittingNogoods(*currentSolution, &possibleActions);
+			p_statistics.droppedActions += actionCount - possibleActions.size();
 
 			if (possibleActions.empty())
 			{
@@ -951,31 +1444,296 @@ auto NativeResolverImpl::p_resolve2(const shared_ptr<PreparedSolution>& initialS
 				{
 					__mydebug_wrapper(*currentSolution, "no solutions");
 				}
+				++p_statistics.discardedSolutions;
 			}
 			else
 			{
-				if (solutions.size()+possibleActions.size() > maxSolutionCount)
+				// diving doesn't grow the tree much, and a restart would lose the solutions found
+				if (!p_searchBudgetExhausted && solutions.size()+possibleActions.size() > maxSolutionCount)
 				{
 					return Resolve2Result::HitSolutionTreeLimit;
 				}
 
-				auto callback = [&solutions](const shared_ptr< Solution >& solution)
+				auto callback = [this, &solutions, &seenScores, dropDuplicates](const shared_ptr< Solution >& solution)
 				{
-					solutions.insert(solution);
+					if (!dropDuplicates)
+					{
+						solutions.push(solution);
+						return;
+					}
+					auto score = solution->getScore();
+					auto insertResult = seenScores.insert({ solution->getFingerprint(), score });
+					if (!insertResult.second)
+					{
+						if (insertResult.first->second >= score)
+						{
+							if (p_debugging)
+							{
+								__mydebug_wrapper(*solution, "duplicate");
+							}
+							++p_statistics.duplicateSolutions;
+							return;
+						}
+						insertResult.first->second = score;
+					}
+					solutions.push(solution);
 				};
 				__pre_apply_actions_to_solution_tree(callback, currentSolution, possibleActions);
 			}
 		}
 	}
+	return Resolve2Result::No;
+}
+
+/* turns the selected elements (the solution found by the sat search or a
+   cached one) into the sequence of actions, each fixing the most important
+   broken element as the tree search does, so the auto-removal and the
+   reasons work the same way; a selected element is never replaced, so the
+   replay either ends or fails with nullptr */
+template < typename SelectionT >
+shared_ptr< PreparedSolution > NativeResolverImpl::p_replaySolution(
+		const PreparedSolution& initialSolution, const SelectionT& selection, size_t id)
+{
+	auto solution = allocateShared< PreparedSolution >(__solution_storage->getArena());
+	solution->id = id;
+	solution->initEntriesFromParent(initialSolution);
+
+	const dg::ElementTable< size_t > noFailCounts;
+	while (true)
+	{
+		auto bp = __get_broken_pair(*__solution_storage, *solution, noFailCounts);
+		if (!bp.versionElement) break;
+
+		auto brokenElement = bp.brokenSuccessor.elementPtr;
+		dg::Element oldElement = nullptr;
+		dg::Element newElement = nullptr;
+		if (selection.isSelected(bp.versionElement))
+		{
+			// the found solution satisfies the broken element by some of its
+			// successors, the best one is taken as the tree search would do
+			ssize_t bestScoreChange = 0;
+			for (auto successor: __solution_storage->getSuccessorElements(brokenElement))
+			{
+				if (!selection.isSelected(successor)) continue;
+
+				dg::Element successorOldElement = nullptr;
+				__solution_storage->simulateSetPackageEntry(*solution, successor, &successorOldElement);
+				auto scoreChange = __score_manager.getScoreChangeValue(
+						p_getScoreChange(successorOldElement, successor, 0));
+				if (!newElement || scoreChange > bestScoreChange)
+				{
+					newElement = successor;
+					oldElement = successorOldElement;
+					bestScoreChange = scoreChange;
+				}
+			}
+		}
+		else
+		{
+			// the found solution has another member of this family
+			oldElement = bp.versionElement;
+			newElement = selection.getSelectedFamilyMember(bp.versionElement);
+		}
+		if (!newElement || (oldElement && selection.isSelected(oldElement)))
+		{
+			if (p_debugging)
+			{
+				__mydebug_wrapper(*solution, "cannot replay: %s: %s",
+						bp.versionElement->toString(), brokenElement->toString());
+			}
+			return nullptr;
+		}
+
+		unique_ptr< Action > action(new Action);
+		action->oldElementPtr = oldElement;
+		action->newElementPtr = newElement;
+		action->introducedBy.versionElementPtr = bp.versionElement;
+		action->introducedBy.brokenElementPtr = brokenElement;
+		action->brokenElementPriority = 0;
+
+		++solution->level;
+		__pre_apply_action(*solution, *solution, std::move(action), 0, solution->id);
+	}
+
+	return solution;
+}
+
+auto NativeResolverImpl::p_resolveBySat(const shared_ptr<PreparedSolution>& initialSolution, Resolver::CallbackType callback) -> Resolve2Result
+{
+	const bool trackReasons = __config->getBool("cupt::resolver::track-reasons");
+
+	if (p_debugging) debug2("started resolving");
+
+	auto getScoreChange = [this](dg::Element oldElement, dg::Element newElement)
+	{
+		return __score_manager.getScoreChangeValue(p_getScoreChange(oldElement, newElement, 0));
+	};
+	SatSearch search(*__solution_storage, *initialSolution, getScoreChange, p_debugging);
+
+	__any_solution_was_found = false;
+	size_t solutionCount = 0;
+	while (search.findBest())
+	{
+		auto solution = p_replaySolution(*initialSolution, search, ++solutionCount);
+		if (!solution)
+		{
+			fatal2i("sat search: the found solution cannot be replayed");
+		}
+		if (p_debugging)
+		{
+			__mydebug_wrapper(*solution, "finished");
+		}
+		solution->finished = 1;
+
+		// the next solutions have to differ from this one
+		vector< dg::Element > insertedElements;
+		for (auto packageEntry: solution->getEntries())
+		{
+			if (packageEntry->level)
+			{
+				insertedElements.push_back(packageEntry->element);
+			}
+		}
+		search.exclude(insertedElements);
+
+		if (!__clean_automatically_installed(*solution))
+		{
+			if (p_debugging)
+			{
+				__mydebug_wrapper(*solution, "auto-discarded");
+			}
+			++p_statistics.discardedSolutions;
+			continue;
+		}
+		__any_solution_was_found = true;
+
+		__final_verify_solution(*solution);
+
+		auto userAnswer = __propose_solution(*solution, callback, trackReasons);
+		switch (userAnswer)
+		{
+			case Resolver::UserAnswer::Accept:
+				return Resolve2Result::Yes;
+			case Resolver::UserAnswer::Abandon:
+				return Resolve2Result::No;
+			case Resolver::UserAnswer::Decline:
+				; // caller hasn't accepted this solution, well, go next...
+		}
+	}
 	if (!__any_solution_was_found)
 	{
-		// no solutions pending, we have a great fail
-		fatal2(__("unable to resolve dependencies, because of:\n\n%s"),
-				__decision_fail_tree.toString());
+		// the clauses don't keep the chains of decisions to report
+		fatal2(__("unable to resolve dependencies, because of:\n\n%s"), __("no solutions"));
 	}
 	return Resolve2Result::No;
 }
 
+namespace {
+
+// the elements of a cached solution in the dependency graph of this resolving
+class CachedSelection
+{
+	const CachedSolution& p_cachedSolution;
+	const PreparedSolution& p_initialSolution;
+	SolutionStorage& p_solutionStorage;
+ public:
+	CachedSelection(const CachedSolution& cachedSolution,
+			const PreparedSolution& initialSolution, SolutionStorage& solutionStorage)
+		: p_cachedSolution(cachedSolution)
+		, p_initialSolution(initialSolution)
+		, p_solutionStorage(solutionStorage)
+	{}
+	bool isSelected(dg::Element element) const
+	{
+		if (p_cachedSolution.elements.count(element->toString()))
+		{
+			return true;
+		}
+		// the not changed families keep their initial elements
+		auto versionElement = element->asVersion();
+		return versionElement && p_initialSolution.getPackageEntry(element) &&
+				!p_cachedSolution.changedPackageNames.count(versionElement->getPackageName());
+	}
+	dg::Element getSelectedFamilyMember(dg::Element element) const
+	{
+		for (auto member: SolutionStorage::getConflictingElements(element))
+		{
+			if (isSelected(member))
+			{
+				return member;
+			}
+		}
+		if (!element->asVersion())
+		{
+			return nullptr;
+		}
+		auto emptyElement = p_solutionStorage.getCorrespondingEmptyElement(element);
+		return (emptyElement && isSelected(emptyElement)) ? emptyElement : nullptr;
+	}
+};
+
+}
+
+CachedSolution NativeResolverImpl::p_getCachedSolution(const PreparedSolution& solution) const
+{
+	CachedSolution result;
+	for (auto packageEntry: solution.getEntries())
+	{
+		if (!packageEntry->level && !packageEntry->autoremoved)
+		{
+			continue; // as in the initial solution
+		}
+		auto element = packageEntry->element;
+		result.elements.insert(element->toString());
+		if (auto versionElement = element->asVersion())
+		{
+			result.changedPackageNames.insert(versionElement->getPackageName());
+		}
+	}
+	return result;
+}
+
+/* the solution accepted before for the same input is proposed without the
+   search, if replaying it in this dependency graph gives the same solution */
+bool NativeResolverImpl::p_proposeCachedSolution(const shared_ptr<PreparedSolution>& initialSolution,
+		Resolver::CallbackType callback, Resolve2Result* result)
+{
+	CachedSolution cachedSolution;
+	if (!p_solutionCache->isEnabled() || !p_solutionCache->load(&cachedSolution))
+	{
+		return false;
+	}
+	if (p_debugging) debug2("replaying the cached solution");
+
+	CachedSelection selection(cachedSolution, *initialSolution, *__solution_storage);
+	auto solution = p_replaySolution(*initialSolution, selection, __solution_storage->getCreatedSolutionCount()+1);
+	if (!solution)
+	{
+		return false;
+	}
+	solution->finished = 1;
+	if (!__clean_automatically_installed(*solution) || !(p_getCachedSolution(*solution) == cachedSolution))
+	{
+		if (p_debugging) debug2("the cached solution differs from the replayed one");
+		return false;
+	}
+	__final_verify_solution(*solution);
+	++p_statistics.solutionCacheHits;
+
+	auto userAnswer = __propose_solution(*solution, callback, __config->getBool("cupt::resolver::track-reasons"));
+	switch (userAnswer)
+	{
+		case Resolver::UserAnswer::Accept:
+			*result = Resolve2Result::Yes;
+			return true;
+		case Resolver::UserAnswer::Abandon:
+			*result = Resolve2Result::No;
+			return true;
+		default:
+			return false; // searching as usual
+	}
+}
+
 }
 }
 
@@ -20,6 +20,7 @@
 
 #include <set>
 #include <list>
+#include <unordered_map>
 
 #include <cupt/fwd.hpp>
 #include <cupt/system/resolver.hpp>
@@ -27,7 +28,11 @@
 #include <internal/nativeresolver/solution.hpp>
 #include <internal/nativeresolver/score.hpp>
 #include <internal/nativeresolver/decisionfailtree.hpp>
+#include <internal/nativeresolver/nogoods.hpp>
+#include <internal/nativeresolver/statistics.hpp>
 #include <internal/nativeresolver/autoremovalpossibility.hpp>
+#include <internal/nativeresolver/solutioncache.hpp>
+#include <internal/nativeresolver/graphcache.hpp>
 
 namespace cupt {
 namespace internal {
@@ -36,8 +41,11 @@ using namespace cache;
 using std::list;
 using std::unique_ptr;
 using std::set;
+using std::unordered_map;
 
 struct BrokenPair;
+class SatSearch;
+class SolutionFrontier;
 
 class NativeResolverImpl
 {
@@ -57,14 +65,53 @@ class NativeResolverImpl
 	unique_ptr< SolutionStorage > __solution_storage;
 	ScoreManager __score_manager;
 	AutoRemovalPossibility __auto_removal_possibility;
+	// the solution-independent answers of p_isCandidateForAutoRemoval
+	// the answers plus 1, 0 for unknown
+	dg::ElementTable< uint8_t > p_autoRemovalCandidacies;
+	mutable dg::ElementTable< ssize_t > p_versionPins;
 
 	map< string, const BinaryVersion* > __old_packages;
 
 	vector< dg::UserRelationExpression > p_userRelationExpressions;
+	bool p_upgradeRequested;
 
 	DecisionFailTree __decision_fail_tree;
+	Nogoods p_nogoods;
 	bool __any_solution_was_found;
 
+	// the system state, to which the requests of the installability checks are added
+	shared_ptr< PreparedSolution > p_installabilityCheckBase;
+
+	ResolverStatistics p_statistics;
+
+	unique_ptr< SolutionCache > p_solutionCache; // nullptr outside resolve()
+	GraphCache p_graphCache; // kept for all the graphs of the resolver
+
+	// the anytime mode: once the time or the leaf limit is hit, the search
+	// stops branching and the best solution found so far is proposed;
+	// completing it gets the same time once more and may process twice as
+	// many solutions as the leaf limit
+	bool p_anytime;
+	bool p_searchBudgetExhausted;
+	ResolverStatistics::Clock::time_point p_searchStartTime;
+	ResolverStatistics::Clock::time_point p_deadline;
+	size_t p_completionSteps;
+
+	// the 'estimated' resolver type: the lowest seen penalties of fixing the
+	// broken elements, the largest one of a solution estimates its remaining
+	// score change; it is a heuristic, which may overestimate the change
+	bool p_estimating;
+	dg::ElementTable< ssize_t > p_fixPenalties; // -1 for not seen
+	struct TopFixPenalties
+	{
+		dg::Element element; // of the largest penalty
+		ssize_t largest;
+		ssize_t second;
+	};
+	TopFixPenalties p_getTopFixPenalties(const PreparedSolution&) const;
+	void p_learnFixPenalty(dg::Element, ssize_t bestScoreChange);
+
+	void p_resetSolutionStorage();
 	void __import_installed_versions();
 	void __import_packages_to_reinstall();
 	float __get_version_weight(const BinaryVersion*) const;
@@ -93,10 +140,24 @@ class NativeResolverImpl
 			const PreparedSolution&, Resolver::CallbackType, bool);
 
 	void __fill_and_process_introduced_by(const PreparedSolution&, const BrokenPair&, ActionContainer* actionsPtr);
+	void p_learnNogood(const PreparedSolution&, const BrokenPair&);
+	void p_dropActionsHittingNogoods(const PreparedSolution&, ActionContainer*);
 	void __generate_possible_actions(vector< unique_ptr< Action > >*, const PreparedSolution&, const BrokenPair&);
 
+	ssize_t p_getFinalScore(const PreparedSolution&) const;
+	void p_printStatistics(ResolverStatistics::Clock::time_point startTime);
+
 	enum class Resolve2Result { Yes, No, HitSolutionTreeLimit };
+	bool p_isSearchBudgetExhausted() const;
+	void p_exhaustSearchBudget(SolutionFrontier&);
+	void p_checkCompletionBudget();
 	Resolve2Result p_resolve2(const shared_ptr<PreparedSolution>&, Resolver::CallbackType);
+	Resolve2Result p_resolveByTree(const shared_ptr<PreparedSolution>&, Resolver::CallbackType);
+	template < typename SelectionT >
+	shared_ptr< PreparedSolution > p_replaySolution(const PreparedSolution&, const SelectionT&, size_t);
+	Resolve2Result p_resolveBySat(const shared_ptr<PreparedSolution>&, Resolver::CallbackType);
+	CachedSolution p_getCachedSolution(const PreparedSolution&) const;
+	bool p_proposeCachedSolution(const shared_ptr<PreparedSolution>&, Resolver::CallbackType, Resolve2Result*);
 
  public:
 	NativeResolverImpl(const shared_ptr< const Config >&, const shared_ptr< const Cache >&);
@@ -106,6 +167,7 @@ class NativeResolverImpl
 	void setAutomaticallyInstalledFlag(const string& packageName, bool flagValue);
 
 	bool resolve(Resolver::CallbackType);
+	bool checkInstallability(const BinaryVersion*, string* failureReason);
 };
 
 }
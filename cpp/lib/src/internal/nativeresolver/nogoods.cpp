@@ -0,0 +1,89 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <algorithm>
+
+#include <internal/nativeresolver/nogoods.hpp>
+
+namespace cupt {
+namespace internal {
+
+void Nogoods::add(vector< dg::Element >&& elements)
+{
+	std::sort(elements.begin(), elements.end(),
+			[](dg::Element left, dg::Element right) { return left->id < right->id; });
+	elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+
+	if (!p_knownSets.insert(elements).second)
+	{
+		return;
+	}
+	auto index = p_sets.size();
+	for (auto element: elements)
+	{
+		p_setIndexesByElement[element].push_back(index);
+	}
+	p_sets.push_back(std::move(elements));
+}
+
+bool Nogoods::isHitBy(const PreparedSolution& solution, dg::Element element) const
+{
+	auto it = p_setIndexesByElement.find(element);
+	if (it == p_setIndexesByElement.end())
+	{
+		return false;
+	}
+
+	auto familyKey = element->getFamilyKey();
+	for (auto index: it->second)
+	{
+		bool allOthersSticked = true;
+		for (auto other: p_sets[index])
+		{
+			if (other == element) continue;
+
+			// a member of the same family is going to be replaced by 'element'
+			auto entry = (other->getFamilyKey() == familyKey) ? nullptr : solution.getPackageEntry(other);
+			if (!entry || !entry->sticked)
+			{
+				allOthersSticked = false;
+				break;
+			}
+		}
+		if (allOthersSticked)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t Nogoods::size() const
+{
+	return p_sets.size();
+}
+
+void Nogoods::clear()
+{
+	p_sets.clear();
+	p_knownSets.clear();
+	p_setIndexesByElement.clear();
+}
+
+}
+}
+
@@ -0,0 +1,51 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_NATIVERESOLVER_NOGOODS_SEEN
+#define CUPT_INTERNAL_NATIVERESOLVER_NOGOODS_SEEN
+
+#include <set>
+#include <unordered_map>
+
+#include <internal/nativeresolver/solution.hpp>
+
+namespace cupt {
+namespace internal {
+
+using std::unordered_map;
+
+/* the sets of elements which cannot be all sticked in a solution that has
+   a chance to be finished: sticked package entries are never changed in
+   the descendant solutions, so a problem caused only by them is never fixed */
+class Nogoods
+{
+	vector< vector< dg::Element > > p_sets;
+	std::set< vector< dg::Element > > p_knownSets;
+	unordered_map< dg::Element, vector< size_t > > p_setIndexesByElement;
+ public:
+	void add(vector< dg::Element >&&);
+	// would a solution contain some set if 'element' was added to it as sticked
+	bool isHitBy(const PreparedSolution&, dg::Element element) const;
+	size_t size() const;
+	void clear();
+};
+
+}
+}
+
+#endif
+
@@ -0,0 +1,408 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <queue>
+#include <algorithm>
+
+#include <internal/nativeresolver/satsearch.hpp>
+
+namespace cupt {
+namespace internal {
+
+typedef SatSolver::Literal Literal;
+
+// improving an already found solution is given up after that many conflicts
+static const size_t minimizationConflictLimit = 20000;
+// bigger families get a linear encoding of 'at most one'
+static const size_t maxPairwiseFamilySize = 6;
+
+SatSearch::SatSearch(SolutionStorage& solutionStorage, const PreparedSolution& initialSolution,
+		const ScoreChangeGetter& getScoreChange, bool debugging)
+	: p_solutionStorage(solutionStorage), p_debugging(debugging), p_exhausted(false)
+{
+	p_collectElements(initialSolution);
+	p_computeCosts(initialSolution, getScoreChange);
+	if (p_debugging)
+	{
+		debug2("sat: %zu selectable elements in %zu families, %zu requirements",
+				p_selectables.size(), p_families.size(), p_requirements.size());
+	}
+}
+
+void SatSearch::p_collectElements(const PreparedSolution& initialSolution)
+{
+	std::queue< dg::Element > queue;
+	auto addSelectable = [this, &queue](dg::Element element)
+	{
+		if (p_selectableIndexes.insert({ element, p_selectables.size() }).second)
+		{
+			p_selectables.push_back(element);
+			queue.push(element);
+		}
+	};
+
+	vector< dg::Element > initialElements;
+	for (auto packageEntry: initialSolution.getEntries())
+	{
+		initialElements.push_back(packageEntry->element);
+	}
+	// the order of variables influences the result among equally scored solutions
+	std::sort(initialElements.begin(), initialElements.end(),
+			[](dg::Element left, dg::Element right) { return left->id < right->id; });
+	for (auto element: initialElements)
+	{
+		addSelectable(element);
+	}
+	while (!queue.empty())
+	{
+		auto element = queue.front();
+		queue.pop();
+
+		if (element->asVersion())
+		{
+			p_solutionStorage.unfoldElement(element);
+			if (auto emptyElement = p_solutionStorage.getCorrespondingEmptyElement(element))
+			{
+				addSelectable(emptyElement);
+			}
+		}
+		for (auto requirement: p_solutionStorage.getSuccessorElements(element))
+		{
+			if (p_requirementIndexes.insert({ requirement, p_requirements.size() }).second)
+			{
+				p_requirements.push_back(requirement);
+				for (auto successor: p_solutionStorage.getSuccessorElements(requirement))
+				{
+					addSelectable(successor);
+				}
+			}
+		}
+	}
+
+	for (uint32_t index = 0; index < p_selectables.size(); ++index)
+	{
+		auto element = p_selectables[index];
+		if (element->asVersion())
+		{
+			p_families[element->getFamilyKey()->id].push_back(index);
+		}
+	}
+}
+
+void SatSearch::p_computeCosts(const PreparedSolution& initialSolution, const ScoreChangeGetter& getScoreChange)
+{
+	p_preferred.assign(p_selectables.size(), false);
+	p_priorities.assign(p_selectables.size(), 0);
+	p_costs.assign(p_selectables.size(), 0);
+
+	for (const auto& family: p_families)
+	{
+		const auto& members = family.second;
+
+		dg::Element initialElement = nullptr;
+		for (auto index: members)
+		{
+			if (initialSolution.getPackageEntry(p_selectables[index]))
+			{
+				initialElement = p_selectables[index];
+			}
+		}
+		if (!initialElement)
+		{
+			// not present in the initial solution, so the empty element is virtually present
+			for (auto index: members)
+			{
+				if (!static_cast< dg::VersionElement >(p_selectables[index])->version)
+				{
+					initialElement = p_selectables[index];
+				}
+			}
+		}
+
+		ssize_t minCost = 0;
+		for (auto index: members)
+		{
+			auto element = p_selectables[index];
+			if (element != initialElement)
+			{
+				p_costs[index] = -getScoreChange(initialElement, element);
+				minCost = std::min(minCost, p_costs[index]);
+			}
+		}
+		// only differences matter, as exactly one member is present
+		for (auto index: members)
+		{
+			p_costs[index] -= minCost;
+			// the cheapest members are tried first
+			p_preferred[index] = true;
+			p_priorities[index] = 0.5 / (1 + p_costs[index]);
+		}
+	}
+	for (uint32_t index = 0; index < p_selectables.size(); ++index)
+	{
+		auto element = p_selectables[index];
+		if (element->getUnsatisfiedType() != dg::Unsatisfied::None)
+		{
+			p_costs[index] = -getScoreChange(nullptr, element);
+			// leaving something unsatisfied is the last resort, so deciding
+			// on it first lets the alternatives be found by propagation
+			p_preferred[index] = (p_costs[index] < 0);
+			p_priorities[index] = 1;
+		}
+	}
+}
+
+/* variables: selectables first, then requirements, then auxiliary ones;
+   a present selectable needs its requirements, a needed requirement needs
+   one of its successors present */
+void SatSearch::p_encode(SatSolver& solver) const
+{
+	auto selectableLiteral = [](uint32_t index, bool positive)
+	{
+		return Literal(index, positive);
+	};
+	auto requirementLiteral = [this](uint32_t index, bool positive)
+	{
+		return Literal(p_selectables.size() + index, positive);
+	};
+	auto getSelectableIndex = [this](dg::Element element)
+	{
+		return p_selectableIndexes.find(element)->second;
+	};
+
+	for (uint32_t index = 0; index < p_selectables.size(); ++index)
+	{
+		solver.addVariable(p_preferred[index], p_priorities[index]);
+	}
+	for (uint32_t index = 0; index < p_requirements.size(); ++index)
+	{
+		solver.addVariable(false);
+	}
+
+	for (uint32_t index = 0; index < p_selectables.size(); ++index)
+	{
+		auto element = p_selectables[index];
+		for (auto requirement: p_solutionStorage.getSuccessorElements(element))
+		{
+			auto requirementIndex = p_requirementIndexes.find(requirement)->second;
+			solver.addClause({ selectableLiteral(index, false), requirementLiteral(requirementIndex, true) });
+		}
+	}
+	for (uint32_t index = 0; index < p_requirements.size(); ++index)
+	{
+		vector< Literal > clause = { requirementLiteral(index, false) };
+		for (auto successor: p_solutionStorage.getSuccessorElements(p_requirements[index]))
+		{
+			clause.push_back(selectableLiteral(getSelectableIndex(successor), true));
+		}
+		solver.addClause(std::move(clause));
+	}
+
+	for (const auto& family: p_families)
+	{
+		const auto& members = family.second;
+
+		vector< Literal > atLeastOne;
+		for (auto index: members)
+		{
+			atLeastOne.push_back(selectableLiteral(index, true));
+		}
+		solver.addClause(std::move(atLeastOne));
+
+		if (members.size() <= maxPairwiseFamilySize)
+		{
+			for (size_t i = 0; i < members.size(); ++i)
+			{
+				for (size_t j = i+1; j < members.size(); ++j)
+				{
+					solver.addClause({ selectableLiteral(members[i], false), selectableLiteral(members[j], false) });
+				}
+			}
+		}
+		else
+		{
+			// 'auxiliary[i]' is true if any of the first i+1 members is present
+			vector< Literal > auxiliary;
+			for (size_t i = 0; i+1 < members.size(); ++i)
+			{
+				auxiliary.push_back(Literal(solver.addVariable(false), true));
+			}
+			for (size_t i = 0; i < members.size(); ++i)
+			{
+				auto member = selectableLiteral(members[i], true);
+				if (i+1 < members.size())
+				{
+					solver.addClause({ ~member, auxiliary[i] });
+				}
+				if (i > 0)
+				{
+					solver.addClause({ ~member, ~auxiliary[i-1] });
+					if (i+1 < members.size())
+					{
+						solver.addClause({ ~auxiliary[i-1], auxiliary[i] });
+					}
+				}
+			}
+		}
+
+		for (auto index: members)
+		{
+			solver.addObjectiveTerm(selectableLiteral(index, true), p_costs[index]);
+		}
+	}
+	for (uint32_t index = 0; index < p_selectables.size(); ++index)
+	{
+		if (p_selectables[index]->getUnsatisfiedType() == dg::Unsatisfied::None) continue;
+
+		auto cost = p_costs[index];
+		if (cost >= 0)
+		{
+			solver.addObjectiveTerm(selectableLiteral(index, true), cost);
+		}
+		else
+		{
+			solver.addObjectiveTerm(selectableLiteral(index, false), -cost);
+		}
+	}
+
+	for (const auto& excludedSolution: p_excludedSolutions)
+	{
+		vector< Literal > clause;
+		for (auto element: excludedSolution)
+		{
+			clause.push_back(selectableLiteral(getSelectableIndex(element), false));
+		}
+		solver.addClause(std::move(clause));
+	}
+}
+
+/* a bisection over the objective bound; a solver refuting a bound cannot
+   be reused for looser ones, so each refutation needs a new solver */
+void SatSearch::p_minimize(unique_ptr< SatSolver >&& solver)
+{
+	auto saveSolution = [this](const SatSolver& solver)
+	{
+		for (uint32_t index = 0; index < p_selectables.size(); ++index)
+		{
+			p_selected[index] = solver.getValue(index);
+		}
+	};
+	saveSolution(*solver);
+
+	size_t improvementCount = 0;
+	size_t probeCount = 0;
+	size_t conflictCount = 0;
+	bool interrupted = false;
+	uint64_t lowerBound = 0;
+	auto objectiveValue = solver->getObjectiveValue();
+	while (lowerBound < objectiveValue && conflictCount < minimizationConflictLimit)
+	{
+		if (!solver)
+		{
+			solver.reset(new SatSolver);
+			p_encode(*solver);
+		}
+		auto bound = lowerBound + (objectiveValue - lowerBound) / 2;
+		solver->setObjectiveBound(bound);
+		auto previousConflictCount = solver->getStatistics().conflicts;
+		auto result = solver->solve(minimizationConflictLimit - conflictCount);
+		++probeCount;
+		conflictCount += solver->getStatistics().conflicts - previousConflictCount;
+		if (result == SatSolver::Result::Satisfiable)
+		{
+			objectiveValue = solver->getObjectiveValue();
+			saveSolution(*solver);
+			++improvementCount;
+		}
+		else
+		{
+			if (result == SatSolver::Result::Interrupted)
+			{
+				interrupted = true;
+			}
+			lowerBound = bound + 1;
+			solver.reset();
+		}
+	}
+
+	if (p_debugging)
+	{
+		debug2("sat: objective %zu after %zu improvements in %zu probes, %zu conflicts%s",
+				size_t(objectiveValue), improvementCount, probeCount, conflictCount,
+				interrupted ? ", not proven optimal" : "");
+	}
+}
+
+bool SatSearch::findBest()
+{
+	if (p_exhausted)
+	{
+		return false;
+	}
+
+	unique_ptr< SatSolver > solver(new SatSolver);
+	p_encode(*solver);
+	if (p_debugging)
+	{
+		debug2("sat: %zu variables, %zu clauses", solver->getVariableCount(), solver->getClauseCount());
+	}
+
+	if (solver->solve() != SatSolver::Result::Satisfiable)
+	{
+		return false;
+	}
+	p_selected.resize(p_selectables.size());
+	p_minimize(std::move(solver));
+
+	return true;
+}
+
+bool SatSearch::isSelected(dg::Element element) const
+{
+	auto it = p_selectableIndexes.find(element);
+	return it != p_selectableIndexes.end() && p_selected[it->second];
+}
+
+dg::Element SatSearch::getSelectedFamilyMember(dg::Element element) const
+{
+	auto familyIt = p_families.find(element->getFamilyKey()->id);
+	if (familyIt != p_families.end())
+	{
+		for (auto index: familyIt->second)
+		{
+			if (p_selected[index])
+			{
+				return p_selectables[index];
+			}
+		}
+	}
+	fatal2i("sat search: no selected member in the family of '%s'", element->toString());
+	__builtin_unreachable();
+}
+
+void SatSearch::exclude(const vector< dg::Element >& elements)
+{
+	if (elements.empty())
+	{
+		p_exhausted = true;
+	}
+	p_excludedSolutions.push_back(elements);
+}
+
+}
+}
+
@@ -0,0 +1,80 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_NATIVERESOLVER_SATSEARCH_SEEN
+#define CUPT_INTERNAL_NATIVERESOLVER_SATSEARCH_SEEN
+
+#include <unordered_map>
+
+#include <internal/nativeresolver/solution.hpp>
+#include <internal/nativeresolver/satsolver.hpp>
+
+namespace cupt {
+namespace internal {
+
+using std::unordered_map;
+
+/* the search for the 'sat' resolver type: the part of the dependency graph
+   reachable from the initial solution is encoded as clauses, and the best
+   assignment by the solution score is found by tightening the objective
+   bound until nothing better exists */
+class SatSearch
+{
+ public:
+	// the score change value of replacing the first element by the second one
+	typedef std::function< ssize_t (dg::Element, dg::Element) > ScoreChangeGetter;
+ private:
+	SolutionStorage& p_solutionStorage;
+	bool p_debugging;
+
+	// the elements which may be present in a solution: versions and unsatisfied ones
+	vector< dg::Element > p_selectables;
+	unordered_map< dg::Element, uint32_t > p_selectableIndexes;
+	vector< bool > p_preferred; // the value to try first
+	vector< double > p_priorities;
+	vector< ssize_t > p_costs;
+	// the elements which must be satisfied if any their predecessor is present
+	vector< dg::Element > p_requirements;
+	unordered_map< dg::Element, uint32_t > p_requirementIndexes;
+	// the selectables of which exactly one is present, by the id of the family key
+	map< uint32_t, vector< uint32_t > > p_families;
+
+	vector< vector< dg::Element > > p_excludedSolutions;
+	bool p_exhausted;
+	vector< bool > p_selected;
+
+	void p_collectElements(const PreparedSolution&);
+	void p_computeCosts(const PreparedSolution&, const ScoreChangeGetter&);
+	void p_encode(SatSolver&) const;
+	void p_minimize(unique_ptr< SatSolver >&&);
+ public:
+	SatSearch(SolutionStorage&, const PreparedSolution& initialSolution, const ScoreChangeGetter&, bool debugging);
+
+	// false if there are no (more) solutions
+	bool findBest();
+	// about the last found solution
+	bool isSelected(dg::Element) const;
+	dg::Element getSelectedFamilyMember(dg::Element) const;
+	// the next solutions will not contain all these elements at once
+	void exclude(const vector< dg::Element >&);
+};
+
+}
+}
+
+#endif
+
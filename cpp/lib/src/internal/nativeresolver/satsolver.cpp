@@ -0,0 +1,852 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <algorithm>
+#include <cmath>
+
+#include <internal/nativeresolver/satsolver.hpp>
+
+namespace cupt {
+namespace internal {
+
+typedef SatSolver::Variable Variable;
+typedef SatSolver::Literal Literal;
+
+namespace {
+
+enum class Value : uint8_t { False, True, Undefined };
+
+const uint32_t noReason = -1;
+const uint32_t objectiveReason = -2;
+
+struct Clause
+{
+	vector< Literal > literals; // the first two are watched
+	bool learnt;
+	bool removed;
+	double activity;
+};
+
+struct Watcher
+{
+	uint32_t clauseIndex;
+	Literal blocker; // if it's true, the clause is satisfied
+};
+
+// unassigned variables ordered by activity, the most active first
+class VariableHeap
+{
+	const vector< double >& p_activities;
+	vector< Variable > p_heap;
+	vector< int32_t > p_positions; // -1 if not in the heap
+
+	bool p_before(Variable left, Variable right) const
+	{
+		if (p_activities[left] != p_activities[right])
+		{
+			return p_activities[left] > p_activities[right];
+		}
+		return left < right;
+	}
+	void p_place(size_t position, Variable variable)
+	{
+		p_heap[position] = variable;
+		p_positions[variable] = position;
+	}
+	void p_siftUp(size_t position)
+	{
+		auto variable = p_heap[position];
+		while (position)
+		{
+			auto parent = (position-1) / 2;
+			if (!p_before(variable, p_heap[parent])) break;
+			p_place(position, p_heap[parent]);
+			position = parent;
+		}
+		p_place(position, variable);
+	}
+	void p_siftDown(size_t position)
+	{
+		auto variable = p_heap[position];
+		while (true)
+		{
+			auto child = position*2 + 1;
+			if (child >= p_heap.size()) break;
+			if (child+1 < p_heap.size() && p_before(p_heap[child+1], p_heap[child]))
+			{
+				++child;
+			}
+			if (!p_before(p_heap[child], variable)) break;
+			p_place(position, p_heap[child]);
+			position = child;
+		}
+		p_place(position, variable);
+	}
+ public:
+	VariableHeap(const vector< double >& activities)
+		: p_activities(activities)
+	{}
+	void addVariable()
+	{
+		p_positions.push_back(-1);
+	}
+	bool empty() const
+	{
+		return p_heap.empty();
+	}
+	void insert(Variable variable)
+	{
+		if (p_positions[variable] >= 0) return;
+		p_heap.push_back(variable);
+		p_siftUp(p_heap.size()-1);
+	}
+	void increase(Variable variable)
+	{
+		if (p_positions[variable] >= 0)
+		{
+			p_siftUp(p_positions[variable]);
+		}
+	}
+	Variable removeTop()
+	{
+		auto result = p_heap.front();
+		p_positions[result] = -1;
+		auto last = p_heap.back();
+		p_heap.pop_back();
+		if (!p_heap.empty())
+		{
+			p_place(0, last);
+			p_siftDown(0);
+		}
+		return result;
+	}
+};
+
+// the restart intervals grow as the Luby sequence: 1 1 2 1 1 2 4 1 1 2 ...
+size_t getLubyValue(size_t index)
+{
+	size_t size = 1;
+	size_t sequence = 0;
+	while (size < index+1)
+	{
+		++sequence;
+		size = size*2 + 1;
+	}
+	while (size-1 != index)
+	{
+		size = (size-1) / 2;
+		--sequence;
+		index %= size;
+	}
+	return size_t(1) << sequence;
+}
+
+const size_t restartUnit = 100;
+const double variableActivityDecay = 0.95;
+const double clauseActivityDecay = 0.999;
+
+}
+
+class SatSolver::Impl
+{
+ public:
+	bool ok;
+
+	vector< Value > values;
+	vector< uint32_t > levels;
+	vector< uint32_t > reasons;
+	vector< uint32_t > trailPositions;
+	vector< bool > phases;
+	vector< double > activities;
+	vector< char > seen;
+	double activityIncrement;
+	VariableHeap heap;
+
+	vector< Literal > trail;
+	vector< size_t > trailLimits;
+	size_t propagationHead;
+
+	vector< Clause > clauses;
+	vector< vector< Watcher > > watches; // by a watched literal
+	double clauseActivityIncrement;
+	size_t learntCount;
+	size_t maxLearntCount;
+
+	vector< uint64_t > objectiveWeights; // by a literal
+	vector< pair< uint64_t, Literal > > objectiveTerms; // the heaviest first
+	bool objectiveTermsSorted;
+	uint64_t objectiveBound;
+	uint64_t objectiveSum; // of the true terms
+	// the terms before this one are assigned and stay so until a backtrack
+	size_t objectiveScanStart;
+	vector< Literal > objectiveReasonBuffer;
+
+	vector< bool > model;
+	uint64_t modelObjectiveValue;
+
+	Statistics statistics;
+
+	Impl();
+
+	Value getValue(Literal literal) const
+	{
+		auto value = values[literal.getVariable()];
+		if (value == Value::Undefined) return value;
+		return ((value == Value::True) == literal.isPositive()) ? Value::True : Value::False;
+	}
+	size_t getDecisionLevel() const
+	{
+		return trailLimits.size();
+	}
+
+	void assign(Literal, uint32_t reason);
+	void cancelUntil(size_t level);
+	uint32_t attachClause(vector< Literal >&&, bool learnt);
+
+	bool propagate(vector< Literal >* conflict);
+	bool propagateObjective(vector< Literal >* conflict);
+	const vector< Literal >& explainObjective(uint32_t positionLimit, uint64_t needed, const Literal* implied);
+	const vector< Literal >& getReasonLiterals(Variable);
+
+	void bumpVariable(Variable);
+	void bumpClause(uint32_t);
+	void decayActivities();
+	bool isRedundant(Variable);
+	void analyze(const vector< Literal >& conflict, vector< Literal >* learnt, size_t* backtrackLevel);
+	void recordLearnt(vector< Literal >&&);
+	void reduceLearnts();
+
+	void sortObjectiveTerms();
+	Result search(size_t conflictLimit);
+};
+
+SatSolver::Impl::Impl()
+	: ok(true), activityIncrement(1), heap(activities), propagationHead(0),
+	clauseActivityIncrement(1), learntCount(0), maxLearntCount(0),
+	objectiveTermsSorted(true), objectiveBound(-1), objectiveSum(0), objectiveScanStart(0),
+	modelObjectiveValue(0), statistics{ 0, 0, 0, 0, 0 }
+{}
+
+void SatSolver::Impl::assign(Literal literal, uint32_t reason)
+{
+	auto variable = literal.getVariable();
+	values[variable] = literal.isPositive() ? Value::True : Value::False;
+	levels[variable] = getDecisionLevel();
+	reasons[variable] = reason;
+	trailPositions[variable] = trail.size();
+	trail.push_back(literal);
+	objectiveSum += objectiveWeights[literal.getIndex()];
+}
+
+void SatSolver::Impl::cancelUntil(size_t level)
+{
+	if (getDecisionLevel() <= level) return;
+
+	for (size_t i = trail.size(); i-- > trailLimits[level];)
+	{
+		auto literal = trail[i];
+		auto variable = literal.getVariable();
+		phases[variable] = literal.isPositive();
+		values[variable] = Value::Undefined;
+		reasons[variable] = noReason;
+		objectiveSum -= objectiveWeights[literal.getIndex()];
+		heap.insert(variable);
+	}
+	trail.resize(trailLimits[level]);
+	trailLimits.resize(level);
+	propagationHead = trail.size();
+	objectiveScanStart = 0;
+}
+
+uint32_t SatSolver::Impl::attachClause(vector< Literal >&& literals, bool learnt)
+{
+	uint32_t index = clauses.size();
+	watches[literals[0].getIndex()].push_back({ index, literals[1] });
+	watches[literals[1].getIndex()].push_back({ index, literals[0] });
+	clauses.push_back({ std::move(literals), learnt, false, 0 });
+	if (learnt)
+	{
+		++learntCount;
+	}
+	return index;
+}
+
+bool SatSolver::Impl::propagate(vector< Literal >* conflict)
+{
+	while (propagationHead < trail.size())
+	{
+		auto trueLiteral = trail[propagationHead++];
+		auto falseLiteral = ~trueLiteral;
+		++statistics.propagations;
+
+		auto& watchers = watches[falseLiteral.getIndex()];
+		size_t i = 0;
+		size_t j = 0;
+		while (i < watchers.size())
+		{
+			auto watcher = watchers[i++];
+			auto& clause = clauses[watcher.clauseIndex];
+			if (clause.removed) continue; // dropping lazily
+			if (getValue(watcher.blocker) == Value::True)
+			{
+				watchers[j++] = watcher;
+				continue;
+			}
+
+			auto& literals = clause.literals;
+			if (literals[0] == falseLiteral)
+			{
+				std::swap(literals[0], literals[1]);
+			}
+			auto first = literals[0];
+			if (first != watcher.blocker && getValue(first) == Value::True)
+			{
+				watchers[j++] = { watcher.clauseIndex, first };
+				continue;
+			}
+
+			bool foundNewWatch = false;
+			for (size_t k = 2; k < literals.size(); ++k)
+			{
+				if (getValue(literals[k]) != Value::False)
+				{
+					std::swap(literals[1], literals[k]);
+					watches[literals[1].getIndex()].push_back({ watcher.clauseIndex, first });
+					foundNewWatch = true;
+					break;
+				}
+			}
+			if (foundNewWatch) continue;
+
+			// the clause is unit or conflicting
+			watchers[j++] = { watcher.clauseIndex, first };
+			if (getValue(first) == Value::False)
+			{
+				while (i < watchers.size())
+				{
+					watchers[j++] = watchers[i++];
+				}
+				watchers.resize(j);
+				*conflict = literals;
+				return false;
+			}
+			assign(first, watcher.clauseIndex);
+		}
+		watchers.resize(j);
+
+		if (objectiveWeights[trueLiteral.getIndex()] && !propagateObjective(conflict))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SatSolver::Impl::propagateObjective(vector< Literal >* conflict)
+{
+	if (objectiveSum > objectiveBound)
+	{
+		*conflict = explainObjective(-1, objectiveBound, nullptr);
+		return false;
+	}
+
+	// the slack only decreases until a backtrack, so the already scanned
+	// heaviest terms need no rescanning
+	auto slack = objectiveBound - objectiveSum;
+	for (; objectiveScanStart < objectiveTerms.size(); ++objectiveScanStart)
+	{
+		const auto& term = objectiveTerms[objectiveScanStart];
+		if (term.first <= slack) break;
+		if (getValue(term.second) == Value::Undefined)
+		{
+			assign(~term.second, objectiveReason);
+		}
+	}
+	return true;
+}
+
+/* the true terms assigned before the position limit, which weigh more
+   than needed, the heaviest first; the implied literal, if any, is put
+   first */
+const vector< Literal >& SatSolver::Impl::explainObjective(
+		uint32_t positionLimit, uint64_t needed, const Literal* implied)
+{
+	auto& result = objectiveReasonBuffer;
+	result.clear();
+	if (implied)
+	{
+		result.push_back(*implied);
+	}
+
+	uint64_t sum = 0;
+	for (const auto& term: objectiveTerms)
+	{
+		if (sum > needed) break;
+		auto literal = term.second;
+		if (getValue(literal) == Value::True && trailPositions[literal.getVariable()] < positionLimit)
+		{
+			result.push_back(~literal);
+			sum += term.first;
+		}
+	}
+	return result;
+}
+
+const vector< Literal >& SatSolver::Impl::getReasonLiterals(Variable variable)
+{
+	auto reason = reasons[variable];
+	if (reason != objectiveReason)
+	{
+		return clauses[reason].literals;
+	}
+
+	auto implied = trail[trailPositions[variable]];
+	auto weight = objectiveWeights[(~implied).getIndex()];
+	// the implied literal was forced since 'sum + weight > bound'
+	if (weight > objectiveBound)
+	{
+		objectiveReasonBuffer.assign(1, implied);
+		return objectiveReasonBuffer;
+	}
+	return explainObjective(trailPositions[variable], objectiveBound - weight, &implied);
+}
+
+void SatSolver::Impl::bumpVariable(Variable variable)
+{
+	activities[variable] += activityIncrement;
+	if (activities[variable] > 1e100)
+	{
+		for (auto& activity: activities)
+		{
+			activity *= 1e-100;
+		}
+		activityIncrement *= 1e-100;
+	}
+	heap.increase(variable);
+}
+
+void SatSolver::Impl::bumpClause(uint32_t index)
+{
+	auto& clause = clauses[index];
+	if (!clause.learnt) return;
+
+	clause.activity += clauseActivityIncrement;
+	if (clause.activity > 1e20)
+	{
+		for (auto& other: clauses)
+		{
+			other.activity *= 1e-20;
+		}
+		clauseActivityIncrement *= 1e-20;
+	}
+}
+
+void SatSolver::Impl::decayActivities()
+{
+	activityIncrement /= variableActivityDecay;
+	clauseActivityIncrement /= clauseActivityDecay;
+}
+
+// all literals of the reason are already in the learnt clause
+bool SatSolver::Impl::isRedundant(Variable variable)
+{
+	const auto& literals = getReasonLiterals(variable);
+	for (size_t i = 1; i < literals.size(); ++i)
+	{
+		auto other = literals[i].getVariable();
+		if (!seen[other] && levels[other] > 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// derives the first unique implication point clause
+void SatSolver::Impl::analyze(const vector< Literal >& conflict,
+		vector< Literal >* learnt, size_t* backtrackLevel)
+{
+	learnt->clear();
+	learnt->push_back(Literal()); // the place for the asserting literal
+
+	vector< Literal > reasonLiterals(conflict);
+	size_t pathCount = 0;
+	bool isFirst = true;
+	size_t index = trail.size();
+	Literal current;
+	while (true)
+	{
+		for (size_t k = isFirst ? 0 : 1; k < reasonLiterals.size(); ++k)
+		{
+			auto literal = reasonLiterals[k];
+			auto variable = literal.getVariable();
+			if (!seen[variable] && levels[variable] > 0)
+			{
+				seen[variable] = 1;
+				bumpVariable(variable);
+				if (levels[variable] >= getDecisionLevel())
+				{
+					++pathCount;
+				}
+				else
+				{
+					learnt->push_back(literal);
+				}
+			}
+		}
+
+		do
+		{
+			--index;
+		} while (!seen[trail[index].getVariable()]);
+		current = trail[index];
+		seen[current.getVariable()] = 0;
+		isFirst = false;
+		if (--pathCount == 0) break;
+
+		auto reason = reasons[current.getVariable()];
+		if (reason != objectiveReason)
+		{
+			bumpClause(reason);
+		}
+		reasonLiterals = getReasonLiterals(current.getVariable());
+	}
+	(*learnt)[0] = ~current;
+
+	vector< Literal > toClear(learnt->begin()+1, learnt->end());
+	size_t j = 1;
+	for (size_t i = 1; i < learnt->size(); ++i)
+	{
+		auto variable = (*learnt)[i].getVariable();
+		if (reasons[variable] == noReason || !isRedundant(variable))
+		{
+			(*learnt)[j++] = (*learnt)[i];
+		}
+	}
+	learnt->resize(j);
+	for (auto literal: toClear)
+	{
+		seen[literal.getVariable()] = 0;
+	}
+
+	*backtrackLevel = 0;
+	if (learnt->size() > 1)
+	{
+		size_t maxIndex = 1;
+		for (size_t i = 2; i < learnt->size(); ++i)
+		{
+			if (levels[(*learnt)[i].getVariable()] > levels[(*learnt)[maxIndex].getVariable()])
+			{
+				maxIndex = i;
+			}
+		}
+		std::swap((*learnt)[1], (*learnt)[maxIndex]);
+		*backtrackLevel = levels[(*learnt)[1].getVariable()];
+	}
+}
+
+void SatSolver::Impl::recordLearnt(vector< Literal >&& learnt)
+{
+	auto asserting = learnt[0];
+	if (learnt.size() == 1)
+	{
+		assign(asserting, noReason);
+	}
+	else
+	{
+		auto index = attachClause(std::move(learnt), true);
+		bumpClause(index);
+		assign(asserting, index);
+	}
+	statistics.learntClauses = learntCount;
+}
+
+void SatSolver::Impl::reduceLearnts()
+{
+	auto isLocked = [this](uint32_t index)
+	{
+		auto first = clauses[index].literals[0];
+		return reasons[first.getVariable()] == index && getValue(first) == Value::True;
+	};
+
+	vector< uint32_t > candidates;
+	for (uint32_t index = 0; index < clauses.size(); ++index)
+	{
+		const auto& clause = clauses[index];
+		if (clause.learnt && !clause.removed && clause.literals.size() > 2 && !isLocked(index))
+		{
+			candidates.push_back(index);
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(),
+			[this](uint32_t left, uint32_t right)
+			{
+				return clauses[left].activity < clauses[right].activity;
+			});
+
+	candidates.resize(candidates.size() / 2);
+	for (auto index: candidates)
+	{
+		auto& clause = clauses[index];
+		clause.removed = true;
+		vector< Literal >().swap(clause.literals);
+		--learntCount;
+	}
+	maxLearntCount += maxLearntCount / 10;
+	statistics.learntClauses = learntCount;
+}
+
+void SatSolver::Impl::sortObjectiveTerms()
+{
+	if (objectiveTermsSorted) return;
+
+	objectiveTerms.clear();
+	objectiveScanStart = 0;
+	for (uint32_t index = 0; index < objectiveWeights.size(); ++index)
+	{
+		if (auto weight = objectiveWeights[index])
+		{
+			objectiveTerms.push_back({ weight, Literal(index/2, !(index%2)) });
+		}
+	}
+	std::stable_sort(objectiveTerms.begin(), objectiveTerms.end(),
+			[](const pair< uint64_t, Literal >& left, const pair< uint64_t, Literal >& right)
+			{
+				return left.first > right.first;
+			});
+	objectiveTermsSorted = true;
+}
+
+auto SatSolver::Impl::search(size_t conflictLimit) -> Result
+{
+	vector< Literal > conflict;
+	vector< Literal > learnt;
+	size_t conflictCount = 0;
+
+	for (size_t restartIndex = 0;; ++restartIndex)
+	{
+		size_t restartConflictLimit = getLubyValue(restartIndex) * restartUnit;
+		size_t restartConflictCount = 0;
+		while (true)
+		{
+			if (!propagate(&conflict))
+			{
+				++statistics.conflicts;
+				++conflictCount;
+				++restartConflictCount;
+				if (getDecisionLevel() == 0)
+				{
+					return Result::Unsatisfiable;
+				}
+
+				size_t backtrackLevel;
+				analyze(conflict, &learnt, &backtrackLevel);
+				cancelUntil(backtrackLevel);
+				recordLearnt(std::move(learnt));
+				decayActivities();
+				continue;
+			}
+
+			if (conflictLimit && conflictCount >= conflictLimit)
+			{
+				return Result::Interrupted;
+			}
+			if (restartConflictCount >= restartConflictLimit)
+			{
+				++statistics.restarts;
+				cancelUntil(0);
+				break;
+			}
+			if (learntCount >= maxLearntCount + trail.size())
+			{
+				reduceLearnts();
+			}
+
+			Variable decision = -1;
+			while (!heap.empty())
+			{
+				auto candidate = heap.removeTop();
+				if (values[candidate] == Value::Undefined)
+				{
+					decision = candidate;
+					break;
+				}
+			}
+			if (decision == Variable(-1))
+			{
+				// all variables are assigned without conflicts
+				model.resize(values.size());
+				for (Variable variable = 0; variable < values.size(); ++variable)
+				{
+					model[variable] = (values[variable] == Value::True);
+				}
+				modelObjectiveValue = objectiveSum;
+				return Result::Satisfiable;
+			}
+
+			++statistics.decisions;
+			trailLimits.push_back(trail.size());
+			assign(Literal(decision, phases[decision]), noReason);
+		}
+	}
+}
+
+
+SatSolver::SatSolver()
+	: p_impl(new Impl)
+{}
+
+SatSolver::~SatSolver()
+{}
+
+auto SatSolver::addVariable(bool preferredValue, double priority) -> Variable
+{
+	auto& impl = *p_impl;
+
+	Variable result = impl.values.size();
+	impl.values.push_back(Value::Undefined);
+	impl.levels.push_back(0);
+	impl.reasons.push_back(noReason);
+	impl.trailPositions.push_back(0);
+	impl.phases.push_back(preferredValue);
+	impl.activities.push_back(priority);
+	impl.seen.push_back(0);
+	impl.watches.resize(impl.watches.size() + 2);
+	impl.objectiveWeights.resize(impl.objectiveWeights.size() + 2);
+	impl.heap.addVariable();
+	impl.heap.insert(result);
+	return result;
+}
+
+size_t SatSolver::getVariableCount() const
+{
+	return p_impl->values.size();
+}
+
+void SatSolver::addClause(vector< Literal > literals)
+{
+	auto& impl = *p_impl;
+	if (!impl.ok) return;
+
+	std::sort(literals.begin(), literals.end());
+	literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
+
+	size_t j = 0;
+	for (size_t i = 0; i < literals.size(); ++i)
+	{
+		auto literal = literals[i];
+		if (i+1 < literals.size() && literals[i+1] == ~literal)
+		{
+			return; // a tautology
+		}
+		switch (impl.getValue(literal))
+		{
+			case Value::True:
+				return; // already satisfied
+			case Value::False:
+				break;
+			case Value::Undefined:
+				literals[j++] = literal;
+		}
+	}
+	literals.resize(j);
+
+	if (literals.empty())
+	{
+		impl.ok = false;
+	}
+	else if (literals.size() == 1)
+	{
+		impl.assign(literals[0], noReason);
+		vector< Literal > conflict;
+		impl.ok = impl.propagate(&conflict);
+	}
+	else
+	{
+		impl.attachClause(std::move(literals), false);
+	}
+}
+
+size_t SatSolver::getClauseCount() const
+{
+	return p_impl->clauses.size() - p_impl->learntCount;
+}
+
+void SatSolver::addObjectiveTerm(Literal literal, uint64_t weight)
+{
+	auto& impl = *p_impl;
+
+	impl.objectiveWeights[literal.getIndex()] += weight;
+	if (impl.getValue(literal) == Value::True)
+	{
+		impl.objectiveSum += weight;
+	}
+	impl.objectiveTermsSorted = false;
+}
+
+void SatSolver::setObjectiveBound(uint64_t bound)
+{
+	p_impl->objectiveBound = bound;
+	p_impl->objectiveScanStart = 0;
+}
+
+auto SatSolver::solve(size_t conflictLimit) -> Result
+{
+	auto& impl = *p_impl;
+	if (!impl.ok) return Result::Unsatisfiable;
+
+	impl.sortObjectiveTerms();
+	if (!impl.maxLearntCount)
+	{
+		impl.maxLearntCount = std::max< size_t >(impl.clauses.size() / 3, 5000);
+	}
+
+	// the bound might have been tightened since the last call
+	vector< Literal > conflict;
+	if (!impl.propagate(&conflict) || !impl.propagateObjective(&conflict) || !impl.propagate(&conflict))
+	{
+		impl.ok = false;
+		return Result::Unsatisfiable;
+	}
+
+	auto result = impl.search(conflictLimit);
+	if (result == Result::Unsatisfiable)
+	{
+		impl.ok = false;
+	}
+	impl.cancelUntil(0);
+	return result;
+}
+
+bool SatSolver::getValue(Variable variable) const
+{
+	return p_impl->model[variable];
+}
+
+uint64_t SatSolver::getObjectiveValue() const
+{
+	return p_impl->modelObjectiveValue;
+}
+
+auto SatSolver::getStatistics() const -> const Statistics&
+{
+	return p_impl->statistics;
+}
+
+}
+}
+
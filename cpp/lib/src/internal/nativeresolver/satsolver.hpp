@@ -0,0 +1,95 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_NATIVERESOLVER_SATSOLVER_SEEN
+#define CUPT_INTERNAL_NATIVERESOLVER_SATSOLVER_SEEN
+
+#include <cupt/common.hpp>
+
+namespace cupt {
+namespace internal {
+
+using std::unique_ptr;
+
+/* a conflict-driven clause learning solver for boolean formulas in the
+   conjunctive normal form, extended with one linear objective: the sum of
+   weights of the true objective terms can be bounded from above, which
+   allows to search for the solutions of the minimal weight */
+class SatSolver
+{
+ public:
+	typedef uint32_t Variable;
+	class Literal
+	{
+		uint32_t p_value;
+		explicit Literal(uint32_t value) : p_value(value) {}
+	 public:
+		Literal() : p_value(0) {}
+		Literal(Variable variable, bool positive)
+			: p_value(variable*2 + !positive)
+		{}
+		Variable getVariable() const { return p_value >> 1; }
+		bool isPositive() const { return !(p_value & 1); }
+		uint32_t getIndex() const { return p_value; }
+		Literal operator~() const { return Literal(p_value ^ 1); }
+		bool operator==(const Literal& other) const { return p_value == other.p_value; }
+		bool operator!=(const Literal& other) const { return p_value != other.p_value; }
+		bool operator<(const Literal& other) const { return p_value < other.p_value; }
+	};
+	enum class Result { Satisfiable, Unsatisfiable, Interrupted };
+	struct Statistics
+	{
+		size_t decisions;
+		size_t propagations;
+		size_t conflicts;
+		size_t restarts;
+		size_t learntClauses;
+	};
+
+	SatSolver();
+	~SatSolver();
+
+	// the preferred value is tried first when deciding on the variable;
+	// variables of a higher priority (from 0 to 1) are decided on first
+	// until the conflicts suggest otherwise
+	Variable addVariable(bool preferredValue, double priority = 0);
+	size_t getVariableCount() const;
+	void addClause(vector< Literal >);
+	size_t getClauseCount() const;
+
+	void addObjectiveTerm(Literal, uint64_t weight);
+	// only solutions with the objective value not greater than the bound are accepted
+	void setObjectiveBound(uint64_t);
+
+	// zero conflict limit means no limit
+	Result solve(size_t conflictLimit = 0);
+
+	// the following two return the data of the last found solution
+	bool getValue(Variable) const;
+	uint64_t getObjectiveValue() const;
+
+	const Statistics& getStatistics() const;
+ private:
+	class Impl;
+	unique_ptr< Impl > p_impl;
+};
+
+}
+}
+
+#endif
+
@@ -86,28 +86,41 @@ ScoreManager::ScoreManager(const Config& config, const shared_ptr< const Cache >
 
 ScoreChange ScoreManager::getVersionScoreChange(const BinaryVersion* originalVersion,
 		const BinaryVersion* supposedVersion) const
+{
+	return getVersionScoreChange(originalVersion, getVersionPin(originalVersion),
+			supposedVersion, getVersionPin(supposedVersion));
+}
+
+ssize_t ScoreManager::getVersionPin(const BinaryVersion* version) const
+{
+	return version ? __cache->getPin(version) : 0;
+}
+
+ScoreChange ScoreManager::getVersionScoreChange(const BinaryVersion* originalVersion, ssize_t originalPin,
+		const BinaryVersion* supposedVersion, ssize_t supposedPin) const
 {
 	ScoreChange scoreChange;
-	p_addVersionChangeWeight(&scoreChange, originalVersion, supposedVersion);
+	p_addVersionChangeWeight(&scoreChange, originalVersion, originalPin, supposedVersion, supposedPin);
 	p_addVersionChangeClass(&scoreChange, originalVersion, supposedVersion);
 	return scoreChange;
 }
 
 void ScoreManager::p_addVersionChangeWeight(ScoreChange* scoreChange,
-		const BinaryVersion* originalVersion, const BinaryVersion* supposedVersion) const
+		const BinaryVersion* originalVersion, ssize_t originalPin,
+		const BinaryVersion* supposedVersion, ssize_t supposedPin) const
 {
 	struct WeightAndPriority
 	{
 		ssize_t weight;
 		ssize_t priority;
 	};
-	auto getWeightAndPriority = [this](const BinaryVersion* bv, ssize_t priorityIfNull)
+	auto getWeightAndPriority = [this](const BinaryVersion* bv, ssize_t pin, ssize_t priorityIfNull)
 	{
 		WeightAndPriority result;
 
 		if (bv)
 		{
-			result.priority = __cache->getPin(bv);
+			result.priority = pin;
 			result.weight = result.priority - __preferred_version_default_pin;
 		}
 		else
@@ -119,8 +132,8 @@ void ScoreManager::p_addVersionChangeWeight(ScoreChange* scoreChange,
 		return result;
 	};
 
-	auto ofOriginal = getWeightAndPriority(originalVersion, 0);
-	auto ofSupposed = getWeightAndPriority(supposedVersion, __preferred_version_default_pin);
+	auto ofOriginal = getWeightAndPriority(originalVersion, originalPin, 0);
+	auto ofSupposed = getWeightAndPriority(supposedVersion, supposedPin, __preferred_version_default_pin);
 
 	auto value = p_getFactoredVersionScore(
 			ofSupposed.weight - ofOriginal.weight,
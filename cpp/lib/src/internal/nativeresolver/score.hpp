@@ -60,13 +60,17 @@ class ScoreManager
 		ssize_t priorityDowngrade;
 	} p_versionFactors; // all in percents
 
-	void p_addVersionChangeWeight(ScoreChange*, const BinaryVersion*, const BinaryVersion*) const;
+	void p_addVersionChangeWeight(ScoreChange*, const BinaryVersion*, ssize_t, const BinaryVersion*, ssize_t) const;
 	void p_addVersionChangeClass(ScoreChange*, const BinaryVersion*, const BinaryVersion*) const;
 	ssize_t p_getFactoredVersionScore(ssize_t, ssize_t) const;
  public:
 	ScoreManager(const Config&, const shared_ptr< const Cache >&);
 	ssize_t getScoreChangeValue(const ScoreChange&) const;
 	ScoreChange getVersionScoreChange(const BinaryVersion*, const BinaryVersion*) const;
+	// the pin is the costly part of a version score, the callers may keep it
+	ssize_t getVersionPin(const BinaryVersion*) const;
+	ScoreChange getVersionScoreChange(const BinaryVersion*, ssize_t originalPin,
+			const BinaryVersion*, ssize_t supposedPin) const;
 	ScoreChange getUnsatisfiedRecommendsScoreChange() const;
 	ScoreChange getUnsatisfiedSuggestsScoreChange() const;
 	ScoreChange getUnsatisfiedSynchronizationScoreChange() const;
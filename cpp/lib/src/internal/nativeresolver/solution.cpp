@@ -15,13 +15,12 @@
 *   Free Software Foundation, Inc.,                                       *
 *   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
 **************************************************************************/
-
 #include <cupt/cache.hpp>
 #include <cupt/cache/binarypackage.hpp>
 
 #include <internal/nativeresolver/solution.hpp>
 #include <internal/nativeresolver/dependencygraph.hpp>
-#include <internal/nativeresolver/cowmap.tpp>
+#include <internal/nativeresolver/hamt.tpp>
 
 namespace cupt {
 namespace internal {
@@ -29,7 +28,7 @@ namespace internal {
 using std::make_pair;
 
 PackageEntry::PackageEntry()
-	: sticked(false), autoremoved(false), level(0)
+	: sticked(false), autoremoved(false), rejectionFingerprint(0), level(0)
 {}
 
 bool PackageEntry::isModificationAllowed(dg::Element element) const
@@ -60,18 +59,12 @@ class VectorBasedMap
  public:
 	void init(container_t&& container) { __container.swap(container); }
 	size_t size() const { return __container.size(); }
-	void reserve(size_t size) { __container.reserve(size); }
-	void shrinkToFit() { __container.shrink_to_fit(); }
 	const_iterator_t begin() const { return __container.begin(); }
 	const_iterator_t end() const { return __container.end(); }
 	const_iterator_t lower_bound(const key_t& key) const
 	{
 		return std::lower_bound(begin(), end(), key, __comparator());
 	}
-	iterator_t lower_bound(const key_t& key)
-	{
-		return std::lower_bound(__container.begin(), __container.end(), key, __comparator());
-	}
 	const_iterator_t find(const key_t& key) const
 	{
 		auto result = lower_bound(key);
@@ -81,21 +74,6 @@ class VectorBasedMap
 		}
 		return result;
 	}
-	// this insert() is called only for unexisting elements
-	iterator_t insert(const_iterator_t position, data_t&& data)
-	{
-		return __container.insert(position, std::move(data));
-	}
-	void push_back(const data_t& data)
-	{
-		__container.push_back(data);
-	}
- public:
-	mutable size_t forkedCount;
-
-	VectorBasedMap()
-		: forkedCount(0)
-	{}
 };
 
 typedef shared_ptr< const PackageEntry > SPPE;
@@ -115,11 +93,64 @@ struct BrokenSuccessorMapKeyGetter
 class BrokenSuccessorMap: public VectorBasedMap< BrokenSuccessor, BrokenSuccessorMapKeyGetter >
 {};
 
+// the finalizer of splitmix64
+static uint64_t mixFingerprint(uint64_t value)
+{
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+	return value ^ (value >> 31);
+}
+
+// the contribution of a package entry without rejections to the fingerprint of a solution
+static uint64_t getEntryFingerprint(dg::Element element, bool sticked)
+{
+	return mixFingerprint((uint64_t(element->id) << 2) | sticked);
+}
+
+// the contribution of a rejected conflictor to the fingerprint of its package entry
+static uint64_t getRejectionFingerprint(dg::Element element)
+{
+	return mixFingerprint((uint64_t(element->id) << 2) | 2);
+}
+
+static uint64_t getEntryFingerprint(const PackageEntry& entry)
+{
+	return getEntryFingerprint(entry.element, entry.sticked) ^ entry.rejectionFingerprint;
+}
+
+// calls the callback for every family of the alternatives rejected by the action
+template < typename CallbackT >
+static void foreachRejectedFamily(const Solution::Action& action, const CallbackT& callback)
+{
+	if (!action.alternatives) return; // nothing to reject
+	const auto& alternatives = *action.alternatives;
+
+	// all
+	uint32_t end = alternatives.elements.size();
+	dg::Element keptFamilyKey = nullptr;
+	if (action.newElementPtr->getUnsatisfiedType() == dg::Unsatisfied::None)
+	{
+		// the preceding ones, except the members of the own family
+		end = action.alternativePosition;
+		keptFamilyKey = action.newElementPtr->getFamilyKey();
+	}
+
+	for (uint32_t head = 0; head < end; ++head)
+	{
+		if (alternatives.familyHeads[head] != head) continue;
+		if (alternatives.elements[head]->getFamilyKey() == keptFamilyKey) continue;
+
+		callback(alternatives, head, end);
+	}
+}
+
 class UnpreparedSolution: public Solution
 {
  public:
 	shared_ptr< const PreparedSolution > p_parent;
 	std::unique_ptr< const Action > p_pendingAction;
+	shared_ptr< PreparedSolution > p_speculativelyPrepared;
+	uint64_t p_fingerprint; // predicted without applying the pending action
 
 	ssize_t getScore() const
 	{
@@ -133,12 +164,17 @@ class UnpreparedSolution: public Solution
 	{
 		return p_parent->getLevel() + 1;
 	}
+	uint64_t getFingerprint() const
+	{
+		return p_fingerprint;
+	}
 
-	shared_ptr< PreparedSolution > prepare() const;
+	shared_ptr< PreparedSolution > prepare(Arena&) const;
 };
 
-SolutionStorage::SolutionStorage(const Config& config, const Cache& cache)
-	: __next_free_id(1), __dependency_graph(config, cache)
+SolutionStorage::SolutionStorage(const Config& config, const Cache& cache, GraphCache* graphCache)
+	: __next_free_id(1), p_clonedSolutionCount(0), p_preparedSolutionCount(0),
+	p_speculativelyPreparedSolutionCount(0), __dependency_graph(config, cache, graphCache)
 {}
 
 SolutionStorage::~SolutionStorage()
@@ -158,10 +194,11 @@ shared_ptr< Solution > SolutionStorage::fakeCloneSolution(const shared_ptr< Prep
 
 shared_ptr< Solution > SolutionStorage::cloneSolution(const shared_ptr< PreparedSolution >& source)
 {
-	auto cloned = std::make_shared< UnpreparedSolution >();
+	auto cloned = allocateShared< UnpreparedSolution >(p_arena);
 
 	cloned->p_parent = source;
 	cloned->id = __get_new_solution_id();
+	++p_clonedSolutionCount;
 
 	// other parts should be done by calling prepare outside
 
@@ -196,7 +233,7 @@ bool SolutionStorage::simulateSetPackageEntry(const PreparedSolution& solution,
 
 	// no conflicting elements in this solution
 	*conflictingElementPtr = nullptr;
-	if (auto versionElement = dynamic_cast<dg::VersionElement>(element))
+	if (auto versionElement = element->asVersion())
 	{
 		if (versionElement->version)
 		{
@@ -207,10 +244,24 @@ bool SolutionStorage::simulateSetPackageEntry(const PreparedSolution& solution,
 	return true;
 }
 
-void SolutionStorage::setRejection(PreparedSolution& solution, dg::Element element)
+// the element whose entry receives the rejections of one family, or nullptr
+dg::Element SolutionStorage::p_getFamilyConflictor(const PreparedSolution& solution,
+		const ActionAlternatives& alternatives, uint32_t head, uint32_t end) const
+{
+	dg::Element conflictingElement = nullptr;
+	for (auto position = head; position < end && !conflictingElement;
+			position = alternatives.nextFamilyMembers[position])
+	{
+		simulateSetPackageEntry(solution, alternatives.elements[position], &conflictingElement);
+	}
+	return conflictingElement;
+}
+
+// the members of one family before the position 'end' are rejected by a single entry update
+void SolutionStorage::p_rejectFamilyAlternatives(PreparedSolution& solution,
+		const ActionAlternatives& alternatives, uint32_t head, uint32_t end)
 {
-	dg::Element conflictingElement;
-	simulateSetPackageEntry(solution, element, &conflictingElement);
+	auto conflictingElement = p_getFamilyConflictor(solution, alternatives, head, end);
 	if (!conflictingElement) return;
 
 	auto conflictorPackageEntryPtr = solution.getPackageEntry(conflictingElement);
@@ -218,8 +269,68 @@ void SolutionStorage::setRejection(PreparedSolution& solution, dg::Element eleme
 	PackageEntry packageEntry = (conflictorPackageEntryPtr ?
 			PackageEntry(*conflictorPackageEntryPtr) : PackageEntry());
 
-	packageEntry.rejectedConflictors.push_front(element);
-	solution.setPackageEntry(conflictingElement, std::move(packageEntry));
+	for (auto position = head; position < end; position = alternatives.nextFamilyMembers[position])
+	{
+		auto element = alternatives.elements[position];
+		// a rejection counted twice would cancel out of the fingerprint
+		if (!packageEntry.isModificationAllowed(element)) continue;
+
+		packageEntry.rejectedConflictors.push_front(element);
+		packageEntry.rejectionFingerprint ^= getRejectionFingerprint(element);
+	}
+	p_setPackageEntry(solution, conflictingElement, std::move(packageEntry));
+}
+
+// the same updates as p_applyAction does, made on the fingerprint only
+uint64_t SolutionStorage::p_predictFingerprint(const PreparedSolution& parent,
+		const Solution::Action& action) const
+{
+	auto result = parent.fingerprint;
+
+	auto newFamilyKey = action.newElementPtr->getFamilyKey();
+	uint64_t replacedFingerprint = 0; // of the entry the new one replaces
+	if (auto oldEntry = parent.getFamilyPackageEntry(action.newElementPtr))
+	{
+		replacedFingerprint = getEntryFingerprint(*oldEntry);
+	}
+
+	foreachRejectedFamily(action, [this, &parent, &result, newFamilyKey, &replacedFingerprint]
+			(const ActionAlternatives& alternatives, uint32_t head, uint32_t end)
+	{
+		auto conflictingElement = p_getFamilyConflictor(parent, alternatives, head, end);
+		if (!conflictingElement) return;
+
+		if (auto oldEntry = parent.getFamilyPackageEntry(conflictingElement))
+		{
+			result ^= getEntryFingerprint(*oldEntry);
+		}
+		auto conflictorPackageEntryPtr = parent.getPackageEntry(conflictingElement);
+		auto entryFingerprint = conflictorPackageEntryPtr ?
+				getEntryFingerprint(*conflictorPackageEntryPtr) : getEntryFingerprint(conflictingElement, false);
+
+		for (auto position = head; position < end; position = alternatives.nextFamilyMembers[position])
+		{
+			auto element = alternatives.elements[position];
+			if (conflictorPackageEntryPtr && !conflictorPackageEntryPtr->isModificationAllowed(element)) continue;
+			auto previous = head;
+			while (previous != position && alternatives.elements[previous] != element)
+			{
+				previous = alternatives.nextFamilyMembers[previous];
+			}
+			if (previous != position) continue;
+
+			entryFingerprint ^= getRejectionFingerprint(element);
+		}
+		result ^= entryFingerprint;
+
+		if (conflictingElement->getFamilyKey() == newFamilyKey)
+		{
+			replacedFingerprint = entryFingerprint;
+		}
+	});
+
+	result ^= replacedFingerprint;
+	return result ^ getEntryFingerprint(action.newElementPtr, action.brokenElementPriority > 0);
 }
 
 void SolutionStorage::setEmpty(PreparedSolution& solution, dg::Element element)
@@ -229,7 +340,48 @@ void SolutionStorage::setEmpty(PreparedSolution& solution, dg::Element element)
 	PackageEntry packageEntry;
 	packageEntry.autoremoved = true;
 
-	solution.setPackageEntry(emptyElement, std::move(packageEntry));
+	p_setPackageEntry(solution, emptyElement, std::move(packageEntry));
+}
+
+dg::Element SolutionStorage::getCorrespondingEmptyElement(dg::Element element)
+{
+	return __dependency_graph.getCorrespondingEmptyElement(element);
+}
+
+namespace {
+
+/* membership in a successor or predecessor list; long lists, like the
+   predecessors of widely used libraries, are sorted once instead of being
+   scanned for every element of the other list */
+class CessorSet
+{
+	static const size_t maxScannedSize = 16;
+
+	const GraphCessorListType& p_list;
+	mutable vector< dg::Element > p_sorted;
+ public:
+	CessorSet(const GraphCessorListType& list)
+		: p_list(list)
+	{}
+	const GraphCessorListType& getList() const
+	{
+		return p_list;
+	}
+	bool contains(dg::Element element) const
+	{
+		if (p_list.size() <= maxScannedSize)
+		{
+			return std::find(p_list.begin(), p_list.end(), element) != p_list.end();
+		}
+		if (p_sorted.empty())
+		{
+			p_sorted.assign(p_list.begin(), p_list.end());
+			std::sort(p_sorted.begin(), p_sorted.end());
+		}
+		return std::binary_search(p_sorted.begin(), p_sorted.end(), element);
+	}
+};
+
 }
 
 void SolutionStorage::p_updateBrokenSuccessors(PreparedSolution& solution,
@@ -242,6 +394,10 @@ void SolutionStorage::p_updateBrokenSuccessors(PreparedSolution& solution,
 		if (result && !*result) result = nullptr;
 		return result;
 	};
+	auto addBs = [&bss](dg::Element element, size_t priority)
+	{
+		bss.addRecord(BrokenSuccessor{ element, priority, element->getTypePriority() });
+	};
 
 	auto reverseDependencyExists = [this, &solution](dg::Element element)
 	{
@@ -254,19 +410,15 @@ void SolutionStorage::p_updateBrokenSuccessors(PreparedSolution& solution,
 		}
 		return false;
 	};
-	auto isPresent = [](const GraphCessorListType& container, dg::Element element)
-	{
-		return std::find(container.begin(), container.end(), element) != container.end();
-	};
 
 	static const GraphCessorListType nullList;
 
-	const auto& successorsOfOld = oldElement ? getSuccessorElements(oldElement) : nullList;
-	const auto& successorsOfNew = getSuccessorElements(newElement);
+	const CessorSet successorsOfOld(oldElement ? getSuccessorElements(oldElement) : nullList);
+	const CessorSet successorsOfNew(getSuccessorElements(newElement));
 	// check direct dependencies of the old element
-	for (auto successorPtr: successorsOfOld)
+	for (auto successorPtr: successorsOfOld.getList())
 	{
-		if (isPresent(successorsOfNew, successorPtr)) continue;
+		if (successorsOfNew.contains(successorPtr)) continue;
 
 		if (adaptedGetBs(successorPtr))
 		{
@@ -277,31 +429,31 @@ void SolutionStorage::p_updateBrokenSuccessors(PreparedSolution& solution,
 		}
 	}
 	// check direct dependencies of the new element
-	for (auto successorPtr: successorsOfNew)
+	for (auto successorPtr: successorsOfNew.getList())
 	{
-		if (isPresent(successorsOfOld, successorPtr)) continue;
+		if (successorsOfOld.contains(successorPtr)) continue;
 
 		auto it = adaptedGetBs(successorPtr);
 		if (!it)
 		{
 			if (!verifyElement(solution, successorPtr))
 			{
-				bss.add(successorPtr, priority);
+				addBs(successorPtr, priority);
 			}
 		}
 		else
 		{
-			bss.add(successorPtr, std::max(*it, priority));
+			addBs(successorPtr, std::max(*it, priority));
 		}
 	}
 
-	const auto& predecessorsOfOld = oldElement ? getPredecessorElements(oldElement) : nullList;
-	const auto& predecessorsOfNew = getPredecessorElements(newElement);
+	const CessorSet predecessorsOfOld(oldElement ? getPredecessorElements(oldElement) : nullList);
+	const CessorSet predecessorsOfNew(getPredecessorElements(newElement));
 	// invalidate those which depend on the old element
-	for (auto predecessorElementPtr: predecessorsOfOld)
+	for (auto predecessorElementPtr: predecessorsOfOld.getList())
 	{
-		if (isPresent(predecessorsOfNew, predecessorElementPtr)) continue;
-		if (isPresent(successorsOfNew, predecessorElementPtr)) continue;
+		if (predecessorsOfNew.contains(predecessorElementPtr)) continue;
+		if (successorsOfNew.contains(predecessorElementPtr)) continue;
 
 		if (reverseDependencyExists(predecessorElementPtr))
 		{
@@ -310,14 +462,14 @@ void SolutionStorage::p_updateBrokenSuccessors(PreparedSolution& solution,
 				// here we assume brokenSuccessors didn't
 				// contain predecessorElementPtr, since as old element was
 				// present, predecessorElementPtr was not broken
-				bss.add(predecessorElementPtr, priority);
+				addBs(predecessorElementPtr, priority);
 			}
 		}
 	}
 	// validate those which depend on the new element
-	for (auto predecessorElementPtr: predecessorsOfNew)
+	for (auto predecessorElementPtr: predecessorsOfNew.getList())
 	{
-		if (isPresent(predecessorsOfOld, predecessorElementPtr)) continue;
+		if (predecessorsOfOld.contains(predecessorElementPtr)) continue;
 
 		if (adaptedGetBs(predecessorElementPtr))
 		{
@@ -326,20 +478,30 @@ void SolutionStorage::p_updateBrokenSuccessors(PreparedSolution& solution,
 	}
 }
 
-void PreparedSolution::setPackageEntry(dg::Element element, PackageEntry&& packageEntry)
+void SolutionStorage::p_setPackageEntry(PreparedSolution& solution,
+		dg::Element element, PackageEntry&& packageEntry)
 {
 	packageEntry.element = element;
-	auto newData = std::make_shared< const PackageEntry >(std::move(packageEntry));
-	p_entries.add(element->getFamilyKey(), std::move(newData));
+	if (auto oldEntry = solution.getFamilyPackageEntry(element))
+	{
+		solution.fingerprint ^= getEntryFingerprint(*oldEntry);
+	}
+	solution.fingerprint ^= getEntryFingerprint(packageEntry);
+	auto newData = allocateShared< PackageEntry >(p_arena, std::move(packageEntry));
+	solution.p_entries.add(element->getFamilyKey(), std::move(newData));
 }
 
 void SolutionStorage::prepareForResolving(PreparedSolution& initialSolution,
 			const map< string, const BinaryVersion* >& oldPackages,
-			const vector< dg::UserRelationExpression >& userRelationExpressions)
+			const vector< dg::UserRelationExpression >& userRelationExpressions, bool upgrade)
 {
 	auto source = __dependency_graph.fill(oldPackages);
 	/* User relation expressions must be processed before any unfoldElement() calls
 	   to early override version checks (if needed) for all explicitly required versions. */
+	if (upgrade)
+	{
+		__dependency_graph.addUpgradeRequests();
+	}
 	for (const auto& userRelationExpression: userRelationExpressions)
 	{
 		__dependency_graph.addUserRelationExpression(userRelationExpression);
@@ -367,6 +529,26 @@ void SolutionStorage::prepareForResolving(PreparedSolution& initialSolution,
 	}
 }
 
+dg::Element SolutionStorage::addIndependentRequests(
+		const vector< dg::UserRelationExpression >& userRelationExpressions)
+{
+	auto requestsElement = __dependency_graph.createRequestsElement();
+	for (const auto& userRelationExpression: userRelationExpressions)
+	{
+		__dependency_graph.addUserRelationExpression(userRelationExpression, requestsElement);
+	}
+	__dependency_graph.unfoldElement(requestsElement);
+	return requestsElement;
+}
+
+void SolutionStorage::insertRequestsElement(PreparedSolution& solution, dg::Element requestsElement)
+{
+	PackageEntry packageEntry;
+	packageEntry.sticked = true;
+	p_setPackageEntry(solution, requestsElement, std::move(packageEntry));
+	p_updateBrokenSuccessors(solution, nullptr, requestsElement, 1);
+}
+
 bool SolutionStorage::verifyElement(const PreparedSolution& solution, dg::Element element) const
 {
 	for (auto successor: getSuccessorElements(element))
@@ -378,7 +560,7 @@ bool SolutionStorage::verifyElement(const PreparedSolution& solution, dg::Elemen
 		else
 		{
 			// check for non-present empty elements as they are virtually present
-			if (auto versionSuccessor = dynamic_cast<dg::VersionElement>(successor))
+			if (auto versionSuccessor = successor->asVersion())
 			{
 				if (!versionSuccessor->version) return true;
 			}
@@ -392,6 +574,16 @@ void SolutionStorage::unfoldElement(dg::Element element)
 	__dependency_graph.unfoldElement(element);
 }
 
+shared_ptr< const Resolver::Reason > SolutionStorage::getReason(const IntroducedBy& introducedBy) const
+{
+	auto& reason = p_reasons[introducedBy];
+	if (!reason)
+	{
+		reason = introducedBy.brokenElementPtr->getReason(*introducedBy.versionElementPtr);
+	}
+	return reason;
+}
+
 void SolutionStorage::processReasonElements(const PreparedSolution& solution,
 		const IntroducedBy& introducedBy, dg::Element insertedElement,
 		const std::function< void (const IntroducedBy&, dg::Element) >& callback) const
@@ -451,42 +643,18 @@ void SolutionStorage::assignAction(Solution& solution, unique_ptr< Solution::Act
 	else
 	{
 		auto unprepared = static_cast< UnpreparedSolution* >(&solution);
+		unprepared->p_fingerprint = p_predictFingerprint(*unprepared->p_parent, *action);
 		unprepared->p_pendingAction = std::move(action);
 	}
 }
 
-static void setRejections(SolutionStorage& solutionStorage, PreparedSolution& solution, const Solution::Action& action)
+void SolutionStorage::p_setRejections(PreparedSolution& solution, const Solution::Action& action)
 {
-	auto reject = [&](dg::Element element)
-	{
-		solutionStorage.setRejection(solution, element);
-	};
-
-	if (!action.allActionNewElements) return; // nothing to reject
-
-	if (action.newElementPtr->getUnsatisfiedType() != dg::Unsatisfied::None)
-	{
-		// all
-		for (auto element: *action.allActionNewElements)
-		{
-			reject(element);
-		}
-	}
-	else
+	foreachRejectedFamily(action, [this, &solution]
+			(const ActionAlternatives& alternatives, uint32_t head, uint32_t end)
 	{
-		auto uselessToReject = [&action](dg::Element element)
-		{
-			return action.newElementPtr->getFamilyKey() == element->getFamilyKey();
-		};
-
-		for (auto element: *action.allActionNewElements)
-		{
-			if (element == action.newElementPtr) break;
-			if (uselessToReject(element)) continue;
-
-			reject(element);
-		}
-	}
+		p_rejectFamilyAlternatives(solution, alternatives, head, end);
+	});
 }
 
 void SolutionStorage::p_setPackageEntryFromAction(PreparedSolution& solution, const Solution::Action& action)
@@ -495,20 +663,21 @@ void SolutionStorage::p_setPackageEntryFromAction(PreparedSolution& solution, co
 	packageEntry.sticked = (action.brokenElementPriority > 0);
 	packageEntry.introducedBy = action.introducedBy;
 	packageEntry.level = solution.level;
-	solution.setPackageEntry(action.newElementPtr, std::move(packageEntry));
+	p_setPackageEntry(solution, action.newElementPtr, std::move(packageEntry));
 }
 
 void SolutionStorage::p_applyAction(PreparedSolution& solution, const Solution::Action& action)
 {
-	setRejections(*this, solution, action);
+	p_setRejections(solution, action);
 	p_setPackageEntryFromAction(solution, action);
-	solution.p_entries.shrinkToFit();
 
-	__dependency_graph.unfoldElement(action.newElementPtr);
+	if (!__dependency_graph.isUnfolded(action.newElementPtr))
+	{
+		__dependency_graph.unfoldElement(action.newElementPtr);
+	}
 
 	p_updateBrokenSuccessors(solution,
 			action.oldElementPtr, action.newElementPtr, action.brokenElementPriority+1);
-	solution.p_brokenSuccessors.shrinkToFit();
 }
 
 shared_ptr< PreparedSolution > SolutionStorage::prepareSolution(const shared_ptr< Solution >& input)
@@ -520,15 +689,70 @@ shared_ptr< PreparedSolution > SolutionStorage::prepareSolution(const shared_ptr
 	else
 	{
 		auto unprepared = static_pointer_cast< UnpreparedSolution >(input);
-		auto converted = unprepared->prepare();
+		if (unprepared->p_speculativelyPrepared)
+		{
+			return unprepared->p_speculativelyPrepared;
+		}
+		auto converted = unprepared->prepare(p_arena);
 		p_applyAction(*converted, *unprepared->p_pendingAction);
+		++p_preparedSolutionCount;
 		return converted;
 	}
 }
 
+bool SolutionStorage::isSpeculativelyPreparable(const Solution& solution) const
+{
+	auto unprepared = dynamic_cast< const UnpreparedSolution* >(&solution);
+	if (!unprepared || unprepared->p_speculativelyPrepared)
+	{
+		return false;
+	}
+
+	const auto& action = *unprepared->p_pendingAction;
+	if (!__dependency_graph.isUnfolded(action.newElementPtr))
+	{
+		return false;
+	}
+	if (action.alternatives)
+	{
+		// rejections must not need to create new empty elements
+		const auto& parent = *unprepared->p_parent;
+		for (auto element: action.alternatives->elements)
+		{
+			auto versionElement = element->asVersion();
+			if (versionElement && versionElement->version && !parent.getFamilyPackageEntry(element) &&
+					!__dependency_graph.findCorrespondingEmptyElement(element))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void SolutionStorage::prepareSolutionSpeculatively(Solution& solution)
+{
+	auto& unprepared = static_cast< UnpreparedSolution& >(solution);
+	auto converted = unprepared.prepare(p_arena);
+	p_applyAction(*converted, *unprepared.p_pendingAction);
+	unprepared.p_speculativelyPrepared = converted;
+	++p_speculativelyPreparedSolutionCount;
+}
+
+void SolutionStorage::addStatistics(ResolverStatistics* statistics) const
+{
+	statistics->createdSolutions += __next_free_id - 1;
+	statistics->clonedSolutions += p_clonedSolutionCount;
+	statistics->preparedSolutions += p_preparedSolutionCount;
+	statistics->speculativelyPreparedSolutions += p_speculativelyPreparedSolutionCount;
+	statistics->graphVertices = __dependency_graph.getVertexCount();
+	statistics->unfoldedElements = __dependency_graph.getUnfoldedElementCount();
+	statistics->graphCacheHits = __dependency_graph.getGraphCacheHitCount();
+}
+
 
 Solution::Solution()
-	: id(0), score(0)
+	: id(0), score(0), estimate(0)
 {}
 
 Solution::~Solution()
@@ -536,22 +760,23 @@ Solution::~Solution()
 
 
 PreparedSolution::PreparedSolution()
-	: level(0), finished(false)
+	: level(0), finished(false), fingerprint(0)
 {}
 
 PreparedSolution::~PreparedSolution()
 {}
 
-shared_ptr< PreparedSolution > UnpreparedSolution::prepare() const
+shared_ptr< PreparedSolution > UnpreparedSolution::prepare(Arena& arena) const
 {
 	if (!p_parent)
 	{
 		fatal2i("nativeresolver: solution: unprepared solution has no parent");
 	}
 
-	auto result = std::make_shared< PreparedSolution >();
+	auto result = allocateShared< PreparedSolution >(arena);
 	result->id = id;
 	result->score = getScore();
+	result->estimate = estimate;
 	result->level = getLevel();
 	result->initEntriesFromParent(*p_parent);
 
@@ -562,6 +787,7 @@ void PreparedSolution::initEntriesFromParent(const PreparedSolution& parent)
 {
 	p_entries = parent.p_entries;
 	p_brokenSuccessors = parent.p_brokenSuccessors;
+	fingerprint = parent.fingerprint;
 }
 
 vector<const PackageEntry*> PreparedSolution::getEntries() const
@@ -584,34 +810,22 @@ vector<dg::Element> PreparedSolution::getInsertedElements() const
 	return result;
 }
 
-BrokenSuccessor PreparedSolution::getMaxBrokenSuccessor(
-		const std::function< bool (BrokenSuccessor, BrokenSuccessor) >& comp) const
-{
-	BrokenSuccessor result{ nullptr, 0 };
-
-	foreachBrokenSuccessor(
-			[&result, &comp](BrokenSuccessor bs)
-			{
-				if (!result.elementPtr || comp(result, bs))
-				{
-					result = bs;
-				}
-			});
-
-	return result;
-}
-
 void PreparedSolution::foreachBrokenSuccessor(
-		const std::function< void (BrokenSuccessor) >& callback) const
+		const std::function< void (const BrokenSuccessor&) >& callback) const
 {
 	p_brokenSuccessors.foreachModifiedEntry(
 			[&callback](const BrokenSuccessor& bs)
 			{
-				if (!bs.priority) return;
-				callback(bs);
+				if (bs.priority) callback(bs);
 			});
 }
 
+void PreparedSolution::foreachTopBrokenSuccessor(
+		const std::function< void (const BrokenSuccessor&) >& callback) const
+{
+	p_brokenSuccessors.foreachModifiedEntryOfMaxRank(callback);
+}
+
 const PackageEntry* PreparedSolution::getFamilyPackageEntry(dg::Element element) const
 {
 	auto entryData = p_entries.get< shared_ptr<const PackageEntry> >(element->getFamilyKey());
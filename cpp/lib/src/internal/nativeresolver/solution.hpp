@@ -20,12 +20,15 @@
 
 #include <map>
 #include <forward_list>
+#include <atomic>
 
 #include <cupt/cache/binaryversion.hpp>
 #include <cupt/system/resolver.hpp>
 
 #include <internal/nativeresolver/dependencygraph.hpp>
-#include <internal/nativeresolver/cowmap.hpp>
+#include <internal/nativeresolver/hamt.hpp>
+#include <internal/nativeresolver/arena.hpp>
+#include <internal/nativeresolver/statistics.hpp>
 
 namespace cupt {
 namespace internal {
@@ -50,10 +53,6 @@ struct IntroducedBy
 	{
 		return std::memcmp(this, &other, sizeof(*this)) < 0;
 	}
-	shared_ptr< const Resolver::Reason > getReason() const
-	{
-		return brokenElementPtr->getReason(*versionElementPtr);
-	}
 };
 
 struct PackageEntry
@@ -62,6 +61,7 @@ struct PackageEntry
 	bool sticked;
 	bool autoremoved;
 	forward_list<dg::Element> rejectedConflictors;
+	uint64_t rejectionFingerprint; // of the rejected conflictors
 	IntroducedBy introducedBy;
 	size_t level;
 
@@ -82,6 +82,17 @@ struct BrokenSuccessor
 {
 	dg::Element elementPtr;
 	size_t priority;
+	size_t typePriority = 0; // of the element
+};
+
+/* the new elements of all actions fixing the same broken element; when one
+   of the actions is applied, the others are rejected family by family, so
+   the families are found once for all the actions */
+struct ActionAlternatives
+{
+	vector< dg::Element > elements; // in the order of the actions
+	vector< uint32_t > familyHeads; // the position of the first element of the same family
+	vector< uint32_t > nextFamilyMembers; // the position of the next one, or the count of elements
 };
 
 class Solution
@@ -91,13 +102,17 @@ class Solution
 	{
 		dg::Element oldElementPtr; // may be NULL
 		dg::Element newElementPtr; // many not be NULL
-		shared_ptr< vector<dg::Element> > allActionNewElements;
+		shared_ptr< const ActionAlternatives > alternatives; // may be NULL
+		uint32_t alternativePosition; // of the new element in the alternatives
 		IntroducedBy introducedBy;
 		size_t brokenElementPriority;
 	};
 
 	size_t id;
 	ssize_t score;
+	// the expected change of the score until the solution is finished, not
+	// positive; stays 0 unless the resolver type is 'estimated'
+	ssize_t estimate;
 
 	Solution();
 	Solution(const Solution&) = delete;
@@ -107,17 +122,19 @@ class Solution
 	virtual ssize_t getScore() const = 0;
 	virtual bool isFinished() const = 0;
 	virtual size_t getLevel() const = 0;
+	// equal for solutions with the same package entries and rejections
+	virtual uint64_t getFingerprint() const = 0;
 };
 
 class PreparedSolution: public Solution
 {
 	friend class SolutionStorage;
+	friend class UnpreparedSolution;
 
-	CowMap< dg::Element, PackageEntryMap > p_entries;
-	CowMap< dg::Element, BrokenSuccessorMap > p_brokenSuccessors;
+	Hamt< dg::Element, PackageEntryMap > p_entries;
+	Hamt< dg::Element, BrokenSuccessorMap > p_brokenSuccessors;
 
 	const PackageEntry* getFamilyPackageEntry(dg::Element) const;
-	void setPackageEntry(dg::Element, PackageEntry&&);
  public:
 	PreparedSolution();
 	~PreparedSolution();
@@ -125,46 +142,83 @@ class PreparedSolution: public Solution
 
 	size_t level;
 	bool finished;
+	uint64_t fingerprint; // relative to the initial solution
 
 	ssize_t getScore() const { return score; }
 	bool isFinished() const { return finished; }
 	size_t getLevel() const { return level; }
+	uint64_t getFingerprint() const { return fingerprint; }
 
 	vector< const PackageEntry* > getEntries() const;
 	vector<dg::Element> getInsertedElements() const;
 
-	void foreachBrokenSuccessor(const std::function< void (BrokenSuccessor) >& callback) const;
-	BrokenSuccessor getMaxBrokenSuccessor(const std::function< bool (BrokenSuccessor, BrokenSuccessor) >&) const;
+	void foreachBrokenSuccessor(const std::function< void (const BrokenSuccessor&) >& callback) const;
+	// those of the highest type priority and, among them, of the highest priority
+	void foreachTopBrokenSuccessor(const std::function< void (const BrokenSuccessor&) >& callback) const;
 
 	const PackageEntry* getPackageEntry(dg::Element) const;
 };
 
 class SolutionStorage
 {
+	// solutions and their parts, must outlive them
+	Arena p_arena;
+
 	size_t __next_free_id;
 	size_t __get_new_solution_id();
 
+	size_t p_clonedSolutionCount;
+	size_t p_preparedSolutionCount;
+	std::atomic< size_t > p_speculativelyPreparedSolutionCount;
+
 	dg::DependencyGraph __dependency_graph;
 	unique_ptr< PackageEntryMap > p_initialEntries;
+	// built only when asked for, i.e. for the proposed solutions and the
+	// failure report, and shared between them
+	mutable map< IntroducedBy, shared_ptr< const Resolver::Reason > > p_reasons;
 
 	void p_updateBrokenSuccessors(PreparedSolution&,
 			dg::Element, dg::Element, size_t priority);
+	void p_setPackageEntry(PreparedSolution&, dg::Element, PackageEntry&&);
+	dg::Element p_getFamilyConflictor(const PreparedSolution&,
+			const ActionAlternatives&, uint32_t head, uint32_t end) const;
+	void p_rejectFamilyAlternatives(PreparedSolution&, const ActionAlternatives&, uint32_t head, uint32_t end);
+	uint64_t p_predictFingerprint(const PreparedSolution&, const Solution::Action&) const;
+	void p_setRejections(PreparedSolution&, const Solution::Action&);
 	inline void p_setPackageEntryFromAction(PreparedSolution&, const Solution::Action&);
 	void p_applyAction(PreparedSolution&, const Solution::Action&);
  public:
-	SolutionStorage(const Config&, const Cache& cache);
+	SolutionStorage(const Config&, const Cache& cache, GraphCache*);
 	~SolutionStorage();
 
+	Arena& getArena() { return p_arena; }
+
 	shared_ptr< Solution > cloneSolution(const shared_ptr< PreparedSolution >&);
 	shared_ptr< Solution > fakeCloneSolution(const shared_ptr< PreparedSolution >&);
+	// the leaves of the solution tree grown so far
+	size_t getCreatedSolutionCount() const { return __next_free_id - 1; }
+	// for the element tables
+	uint32_t getFirstElementId() const { return __dependency_graph.getFirstElementId(); }
 
 	void prepareForResolving(PreparedSolution&,
 			const map< string, const BinaryVersion* >&,
-			const vector< dg::UserRelationExpression >&);
+			const vector< dg::UserRelationExpression >&, bool upgrade);
+
+	/* resolving several sets of requests independently of each other with
+	   the same graph: each set gets its own requests element, which is put
+	   to a copy of the initial solution instead of the common one */
+	dg::Element addIndependentRequests(const vector< dg::UserRelationExpression >&);
+	void insertRequestsElement(PreparedSolution&, dg::Element);
 
 	void assignAction(Solution& solution, unique_ptr< Solution::Action >&& action);
 	shared_ptr< PreparedSolution > prepareSolution(const shared_ptr< Solution >&);
 
+	/* speculative preparation doesn't modify the dependency graph, so it may
+	   run concurrently for different solutions, as long as nothing else
+	   modifies the graph meanwhile */
+	bool isSpeculativelyPreparable(const Solution&) const;
+	void prepareSolutionSpeculatively(Solution&);
+
 	const GraphCessorListType& getSuccessorElements(dg::Element) const;
 	const GraphCessorListType& getPredecessorElements(dg::Element) const;
 	bool verifyElement(const PreparedSolution&, dg::Element) const;
@@ -172,12 +226,15 @@ class SolutionStorage
 	// may include parameter itself
 	static const vector<dg::Element>& getConflictingElements(dg::Element);
 	bool simulateSetPackageEntry(const PreparedSolution&, dg::Element, dg::Element*) const;
-	void setRejection(PreparedSolution&, dg::Element);
 	void setEmpty(PreparedSolution&, dg::Element);
+	dg::Element getCorrespondingEmptyElement(dg::Element);
 	void unfoldElement(dg::Element);
 
+	shared_ptr< const Resolver::Reason > getReason(const IntroducedBy&) const;
 	void processReasonElements(const PreparedSolution&, const IntroducedBy&, dg::Element,
 			const std::function< void (const IntroducedBy&, dg::Element) >&) const;
+
+	void addStatistics(ResolverStatistics*) const;
 };
 
 }
@@ -0,0 +1,242 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <cupt/config.hpp>
+#include <cupt/cache.hpp>
+#include <cupt/cache/binaryversion.hpp>
+#include <cupt/file.hpp>
+#include <cupt/hashsums.hpp>
+
+#include <internal/nativeresolver/solutioncache.hpp>
+#include <internal/cachefiles.hpp>
+#include <internal/filesystem.hpp>
+
+namespace cupt {
+namespace internal {
+
+bool CachedSolution::operator==(const CachedSolution& other) const
+{
+	return changedPackageNames == other.changedPackageNames && elements == other.elements;
+}
+
+namespace {
+
+const string optionName = "cupt::resolver::solution-cache-directory";
+
+string getFileDigest(const string& path)
+{
+	if (!fs::fileExists(path))
+	{
+		return "-";
+	}
+	HashSums hashSums;
+	hashSums.fill(path);
+	return hashSums[HashSums::SHA256];
+}
+
+/* the results are shared between hosts having the same indexes, so the
+   index is identified by the hash sums the release file lists for it,
+   which, unlike reading the index through, costs almost nothing */
+string getIndexDigest(const Config& config, const Cache::IndexEntry& indexEntry)
+{
+	auto path = cachefiles::getPathOfIndexList(config, indexEntry);
+	if (!fs::fileExists(path))
+	{
+		return "-";
+	}
+	if (cachefiles::getPathOfMasterReleaseLikeList(config, indexEntry).empty())
+	{
+		return getFileDigest(path);
+	}
+
+	string result;
+	for (const auto& record: cachefiles::getDownloadInfoOfIndexList(config, indexEntry))
+	{
+		for (const auto& value: record.hashSums.values)
+		{
+			if (!value.empty()) result += value + ' ';
+		}
+	}
+	if (result.empty()) // the release file doesn't list the hash sums
+	{
+		return getFileDigest(path);
+	}
+	return result;
+}
+
+}
+
+// only contents are used, not local paths or file times
+string getIndexesKey(const Config& config, const Cache& cache)
+{
+	string result;
+	for (const auto& indexEntry: cache.getIndexEntries())
+	{
+		result += format2("index %d %s %s %s %s\n", int(indexEntry.category), indexEntry.uri,
+				indexEntry.distribution, indexEntry.component, getIndexDigest(config, indexEntry));
+	}
+	return result;
+}
+
+namespace {
+
+bool isKeyOption(const string& name)
+{
+	static const vector< string > prefixes = {
+		"cupt::resolver::", "cupt::cache::", "apt::install-", "apt::architecture", "apt::default-release" };
+
+	if (name == optionName) return false;
+	for (const auto& prefix: prefixes)
+	{
+		if (name.compare(0, prefix.size(), prefix) == 0) return true;
+	}
+	return false;
+}
+
+string getKey(const Config& config, const Cache& cache,
+		const map< string, const BinaryVersion* >& oldPackages,
+		const map< string, bool >& autoStatusOverrides,
+		const vector< dg::UserRelationExpression >& userRelationExpressions, bool upgradeRequested)
+{
+	string result = getIndexesKey(config, cache);
+
+	for (const auto& path: fs::glob(config.getPath("dir::etc::preferencesparts") + "/*"))
+	{
+		result += format2("preferences %s %s\n", fs::filename(path), getFileDigest(path));
+	}
+	result += "preferences " + getFileDigest(config.getPath("dir::etc::preferences")) + '\n';
+
+	for (const auto& item: oldPackages)
+	{
+		result += format2("installed %s %s %d\n", item.first, item.second->versionString,
+				int(cache.isAutomaticallyInstalled(item.first)));
+	}
+	for (const auto& item: autoStatusOverrides)
+	{
+		result += format2("auto %s %d\n", item.first, int(item.second));
+	}
+
+	for (const auto& ure: userRelationExpressions)
+	{
+		result += format2("request %d %u %d %s %s\n", int(ure.invert), unsigned(ure.importance),
+				int(ure.asAuto), ure.expression.toString(), ure.annotation);
+	}
+	if (upgradeRequested)
+	{
+		result += "request upgrade\n";
+	}
+
+	for (const auto& name: config.getScalarOptionNames())
+	{
+		if (!isKeyOption(name)) continue;
+		result += format2("option %s %s\n", name, config.getString(name));
+	}
+	for (const auto& name: config.getListOptionNames())
+	{
+		if (!isKeyOption(name)) continue;
+		result += format2("option %s %s\n", name, join(" ", config.getList(name)));
+	}
+
+	return result;
+}
+
+}
+
+SolutionCache::SolutionCache(const Config& config, const Cache& cache,
+		const map< string, const BinaryVersion* >& oldPackages,
+		const map< string, bool >& autoStatusOverrides,
+		const vector< dg::UserRelationExpression >& userRelationExpressions, bool upgradeRequested)
+{
+	auto directory = config.getString(optionName);
+	if (directory.empty()) return;
+
+	auto key = getKey(config, cache, oldPackages, autoStatusOverrides, userRelationExpressions, upgradeRequested);
+	p_path = directory + '/' + HashSums::getHashOfString(HashSums::SHA256, key);
+}
+
+bool SolutionCache::load(CachedSolution* cachedSolution) const
+{
+	if (!fs::fileExists(p_path)) return false;
+
+	string openError;
+	File file(p_path, "r", openError);
+	if (!openError.empty())
+	{
+		warn2(__("unable to open the file '%s': %s"), p_path, openError);
+		return false;
+	}
+
+	string line;
+	while (!file.getLine(line).eof())
+	{
+		auto spacePosition = line.find(' ');
+		if (spacePosition == string::npos)
+		{
+			warn2(__("the cached solution '%s' is malformed"), p_path);
+			return false;
+		}
+		auto kind = line.substr(0, spacePosition);
+		auto value = line.substr(spacePosition + 1);
+		if (kind == "package")
+		{
+			cachedSolution->changedPackageNames.insert(std::move(value));
+		}
+		else if (kind == "element")
+		{
+			cachedSolution->elements.insert(std::move(value));
+		}
+		else
+		{
+			warn2(__("the cached solution '%s' is malformed"), p_path);
+			return false;
+		}
+	}
+	return true;
+}
+
+void SolutionCache::store(const CachedSolution& cachedSolution) const
+{
+	auto directory = fs::dirname(p_path);
+	if (!fs::dirExists(directory))
+	{
+		fs::mkpath(directory);
+	}
+
+	auto temporaryPath = p_path + ".new";
+	{
+		string openError;
+		File file(temporaryPath, "w", openError);
+		if (!openError.empty())
+		{
+			warn2(__("unable to open the file '%s': %s"), temporaryPath, openError);
+			return;
+		}
+		for (const auto& packageName: cachedSolution.changedPackageNames)
+		{
+			file.put("package " + packageName + '\n');
+		}
+		for (const auto& element: cachedSolution.elements)
+		{
+			file.put("element " + element + '\n');
+		}
+	}
+	fs::move(temporaryPath, p_path);
+}
+
+}
+}
+
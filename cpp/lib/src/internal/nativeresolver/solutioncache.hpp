@@ -0,0 +1,63 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_NATIVERESOLVER_SOLUTIONCACHE_SEEN
+#define CUPT_INTERNAL_NATIVERESOLVER_SOLUTIONCACHE_SEEN
+
+#include <set>
+
+#include <internal/nativeresolver/solution.hpp>
+
+namespace cupt {
+namespace internal {
+
+// identifies the contents of the indexes, the graph cache uses it too
+string getIndexesKey(const Config&, const Cache&);
+
+/* the changes of an accepted solution against the initial one; the
+   dependency graph is built anew for every resolving, so the elements are
+   identified by their string forms */
+struct CachedSolution
+{
+	std::set< string > changedPackageNames;
+	std::set< string > elements; // present ones, of the changed families
+
+	bool operator==(const CachedSolution&) const;
+};
+
+/* accepted solutions stored in a directory, one file per input of the
+   resolver: the index and pin files, the installed system, the requests
+   and the resolver options */
+class SolutionCache
+{
+	string p_path; // empty if the cache is off
+ public:
+	SolutionCache(const Config&, const Cache&,
+			const map< string, const BinaryVersion* >& oldPackages,
+			const map< string, bool >& autoStatusOverrides,
+			const vector< dg::UserRelationExpression >&, bool upgradeRequested);
+
+	bool isEnabled() const { return !p_path.empty(); }
+	bool load(CachedSolution*) const;
+	void store(const CachedSolution&) const;
+};
+
+}
+}
+
+#endif
+
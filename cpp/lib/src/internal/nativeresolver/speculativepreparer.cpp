@@ -0,0 +1,111 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <internal/nativeresolver/speculativepreparer.hpp>
+
+namespace cupt {
+namespace internal {
+
+SpeculativePreparer::SpeculativePreparer(SolutionStorage& solutionStorage, size_t threadCount)
+	: p_solutionStorage(solutionStorage), p_generation(0), p_stopping(false),
+	p_activeWorkerCount(0), p_batch(nullptr), p_nextIndex(0)
+{
+	for (size_t i = 1; i < threadCount; ++i)
+	{
+		p_workers.emplace_back([this]() { p_workerLoop(); });
+	}
+}
+
+SpeculativePreparer::~SpeculativePreparer()
+{
+	{
+		std::lock_guard< std::mutex > lock(p_mutex);
+		p_stopping = true;
+	}
+	p_batchStartedCV.notify_all();
+	for (auto& worker: p_workers)
+	{
+		worker.join();
+	}
+}
+
+void SpeculativePreparer::p_processBatch(const vector< shared_ptr< Solution > >& batch)
+{
+	size_t index;
+	while ((index = p_nextIndex++) < batch.size())
+	{
+		try
+		{
+			p_solutionStorage.prepareSolutionSpeculatively(*batch[index]);
+		}
+		catch (...)
+		{
+			// the solution stays unprepared, the error (if any) will
+			// reappear during the regular preparation
+		}
+	}
+}
+
+void SpeculativePreparer::p_workerLoop()
+{
+	size_t seenGeneration = 0;
+	while (true)
+	{
+		const vector< shared_ptr< Solution > >* batch;
+		{
+			std::unique_lock< std::mutex > lock(p_mutex);
+			p_batchStartedCV.wait(lock, [this, &seenGeneration]()
+					{ return p_stopping || p_generation != seenGeneration; });
+			if (p_stopping) return;
+			seenGeneration = p_generation;
+			batch = p_batch;
+			if (!batch) continue; // woke up too late, the batch is already done
+			++p_activeWorkerCount;
+		}
+
+		p_processBatch(*batch);
+
+		{
+			std::lock_guard< std::mutex > lock(p_mutex);
+			--p_activeWorkerCount;
+		}
+		p_batchFinishedCV.notify_one();
+	}
+}
+
+void SpeculativePreparer::prepare(const vector< shared_ptr< Solution > >& solutions)
+{
+	{
+		std::lock_guard< std::mutex > lock(p_mutex);
+		p_solutionStorage.getArena().setShared(true);
+		p_batch = &solutions;
+		p_nextIndex = 0;
+		++p_generation;
+	}
+	p_batchStartedCV.notify_all();
+
+	p_processBatch(solutions);
+
+	std::unique_lock< std::mutex > lock(p_mutex);
+	p_batchFinishedCV.wait(lock, [this]() { return p_activeWorkerCount == 0; });
+	p_batch = nullptr;
+	p_solutionStorage.getArena().setShared(false);
+}
+
+}
+}
+
@@ -0,0 +1,62 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_NATIVERESOLVER_SPECULATIVEPREPARER_SEEN
+#define CUPT_INTERNAL_NATIVERESOLVER_SPECULATIVEPREPARER_SEEN
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include <internal/nativeresolver/solution.hpp>
+
+namespace cupt {
+namespace internal {
+
+// prepares batches of solutions using a pool of threads; the calling thread
+// takes part in the work too, so 'threadCount-1' threads are spawned
+class SpeculativePreparer
+{
+	SolutionStorage& p_solutionStorage;
+	vector< std::thread > p_workers;
+
+	std::mutex p_mutex;
+	std::condition_variable p_batchStartedCV;
+	std::condition_variable p_batchFinishedCV;
+	size_t p_generation;
+	bool p_stopping;
+	size_t p_activeWorkerCount;
+
+	const vector< shared_ptr< Solution > >* p_batch;
+	std::atomic< size_t > p_nextIndex;
+
+	void p_processBatch(const vector< shared_ptr< Solution > >&);
+	void p_workerLoop();
+ public:
+	SpeculativePreparer(SolutionStorage&, size_t threadCount);
+	~SpeculativePreparer();
+
+	// returns when all solutions of the batch are prepared
+	void prepare(const vector< shared_ptr< Solution > >&);
+};
+
+}
+}
+
+#endif
+
@@ -0,0 +1,88 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#include <internal/nativeresolver/statistics.hpp>
+
+namespace cupt {
+namespace internal {
+
+ResolverStatistics::ResolverStatistics()
+	: createdSolutions(0), clonedSolutions(0), preparedSolutions(0),
+	speculativelyPreparedSolutions(0), discardedSolutions(0), duplicateSolutions(0), proposedSolutions(0), solutionCacheHits(0),
+	restarts(0), searchBudgetExhaustions(0), brokenPairLookups(0), steps(0), generatedActions(0), maxStepActions(0),
+	droppedActions(0), graphVertices(0), unfoldedElements(0), graphCacheHits(0),
+	totalTime(0), graphFillTime(0), autoRemovalTime(0), verificationTime(0), proposalTime(0)
+{}
+
+void ResolverStatistics::addStep(size_t actionCount)
+{
+	++steps;
+	generatedActions += actionCount;
+	if (actionCount > maxStepActions)
+	{
+		maxStepActions = actionCount;
+	}
+}
+
+static double toSeconds(ResolverStatistics::Clock::duration duration)
+{
+	return std::chrono::duration< double >(duration).count();
+}
+
+/* one 'name: value' pair per line, so the output can be easily parsed;
+   the search time is what is left of the total time after other phases */
+void ResolverStatistics::print() const
+{
+	auto printCounter = [](const char* name, size_t value)
+	{
+		debug2("resolver statistics: %s: %zu", name, value);
+	};
+	printCounter("created-solutions", createdSolutions);
+	printCounter("cloned-solutions", clonedSolutions);
+	printCounter("prepared-solutions", preparedSolutions);
+	printCounter("speculatively-prepared-solutions", speculativelyPreparedSolutions);
+	printCounter("discarded-solutions", discardedSolutions);
+	printCounter("duplicate-solutions", duplicateSolutions);
+	printCounter("proposed-solutions", proposedSolutions);
+	printCounter("solution-cache-hits", solutionCacheHits);
+	printCounter("restarts", restarts);
+	printCounter("search-budget-exhaustions", searchBudgetExhaustions);
+	printCounter("broken-pair-lookups", brokenPairLookups);
+	printCounter("steps", steps);
+	printCounter("generated-actions", generatedActions);
+	printCounter("max-step-actions", maxStepActions);
+	printCounter("dropped-actions", droppedActions);
+	printCounter("graph-vertices", graphVertices);
+	printCounter("unfolded-elements", unfoldedElements);
+	printCounter("graph-cache-hits", graphCacheHits);
+
+	auto printTime = [](const char* name, Clock::duration value)
+	{
+		debug2("resolver statistics: %s: %.6f", name, toSeconds(value));
+	};
+	auto searchTime = totalTime - graphFillTime - autoRemovalTime - verificationTime - proposalTime;
+	printTime("total-time", totalTime);
+	printTime("graph-fill-time", graphFillTime);
+	printTime("search-time", searchTime);
+	printTime("auto-removal-time", autoRemovalTime);
+	printTime("verification-time", verificationTime);
+	printTime("proposal-time", proposalTime);
+}
+
+}
+}
+
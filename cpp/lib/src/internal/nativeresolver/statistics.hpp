@@ -0,0 +1,79 @@
+/**************************************************************************
+*   Copyright (C) 2016 by Eugene V. Lyubimkin                             *
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License                  *
+*   (version 3 or above) as published by the Free Software Foundation.    *
+*                                                                         *
+*   This program is distributed in the hope that it will be useful,       *
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+*   GNU General Public License for more details.                          *
+*                                                                         *
+*   You should have received a copy of the GNU GPL                        *
+*   along with this program; if not, write to the                         *
+*   Free Software Foundation, Inc.,                                       *
+*   51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA               *
+**************************************************************************/
+#ifndef CUPT_INTERNAL_NATIVERESOLVER_STATISTICS_SEEN
+#define CUPT_INTERNAL_NATIVERESOLVER_STATISTICS_SEEN
+
+#include <chrono>
+
+namespace cupt {
+namespace internal {
+
+// counters and phase times of one resolving
+struct ResolverStatistics
+{
+	typedef std::chrono::steady_clock Clock;
+
+	size_t createdSolutions;
+	size_t clonedSolutions;
+	size_t preparedSolutions;
+	size_t speculativelyPreparedSolutions;
+	size_t discardedSolutions;
+	size_t duplicateSolutions;
+	size_t proposedSolutions;
+	size_t solutionCacheHits;
+	size_t restarts;
+	size_t searchBudgetExhaustions;
+	size_t brokenPairLookups;
+	size_t steps;
+	size_t generatedActions;
+	size_t maxStepActions;
+	size_t droppedActions;
+	size_t graphVertices;
+	size_t unfoldedElements;
+	size_t graphCacheHits;
+
+	Clock::duration totalTime;
+	Clock::duration graphFillTime;
+	Clock::duration autoRemovalTime;
+	Clock::duration verificationTime;
+	Clock::duration proposalTime; // includes the time of the caller's callback
+
+	ResolverStatistics();
+	void addStep(size_t actionCount);
+	void print() const;
+};
+
+// adds the time of its life to the given duration
+class PhaseTimer
+{
+	ResolverStatistics::Clock::duration& p_duration;
+	ResolverStatistics::Clock::time_point p_start;
+ public:
+	PhaseTimer(ResolverStatistics::Clock::duration& duration)
+		: p_duration(duration), p_start(ResolverStatistics::Clock::now())
+	{}
+	~PhaseTimer()
+	{
+		p_duration += ResolverStatistics::Clock::now() - p_start;
+	}
+};
+
+}
+}
+
+#endif
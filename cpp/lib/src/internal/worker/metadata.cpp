@@ -95,6 +95,7 @@ std::function< string () > generateMovingSub(const SharedTempPath& downloadPath,
 	return [downloadPath=downloadPath, targetPath]() mutable -> string
 	{
 		ioi::removeIndexOfIndex(targetPath);
+		cachefiles::removeCompactReleaseInfo(targetPath);
 		if (fs::move(downloadPath, targetPath))
 		{
 			downloadPath.abandon();
@@ -825,6 +826,8 @@ void MetadataWorker::__list_cleanup(const string& lockPath)
 		if (includeIoi)
 		{
 			addUsedPattern(ioi::getIndexOfIndexPath(pathOfIndexList));
+			addUsedPattern(cachefiles::getPathOfCompactReleaseInfo(
+					cachefiles::getPathOfInReleaseList(*_config, indexEntry)));
 		}
 
 		auto translationsPossiblePaths =
@@ -885,6 +888,33 @@ void MetadataWorker::p_generateIndexesOfIndexes(const cachefiles::IndexEntry& in
 	}
 }
 
+// done after all update threads are finished since index entries share release files
+void MetadataWorker::p_generateCompactReleaseInfos()
+{
+	if (_config->getBool("cupt::worker::simulate")) return;
+
+	set< string > releasePaths;
+	for (const auto& indexEntry: _cache->getIndexEntries())
+	{
+		auto path = cachefiles::getPathOfMasterReleaseLikeList(*_config, indexEntry);
+		if (!path.empty())
+		{
+			releasePaths.insert(path);
+		}
+	}
+	for (const auto& path: releasePaths)
+	{
+		try
+		{
+			cachefiles::generateCompactReleaseInfo(path, getDownloadPath(path) + ".info");
+		}
+		catch (Exception&)
+		{
+			// the cache will fall back to parsing the release file itself
+		}
+	}
+}
+
 bool MetadataWorker::p_metadataUpdateThread(download::Manager& downloadManager, const cachefiles::IndexEntry& indexEntry)
 {
 	// wrapping all errors here
@@ -990,6 +1020,10 @@ void MetadataWorker::updateReleaseAndIndexData(const shared_ptr< download::Progr
 	}
 
 	auto masterExitCode = p_runMetadataUpdateThreads(downloadProgress);
+	if (_config->getBool("cupt::update::generate-index-of-index"))
+	{
+		p_generateCompactReleaseInfos();
+	}
 
 	if (_config->getBool("apt::get::list-cleanup"))
 	{
@@ -49,6 +49,7 @@ class MetadataWorker: public virtual WorkerBase
 	bool __update_index(download::Manager&, const cachefiles::IndexEntry&,
 			IndexUpdateInfo&&, bool, bool&);
 	void p_generateIndexesOfIndexes(const cachefiles::IndexEntry&);
+	void p_generateCompactReleaseInfos();
 	bool __update_main_index(download::Manager&, const cachefiles::IndexEntry&,
 			bool releaseFileChanged, bool& indexFileChanged);
 	void __update_translations(download::Manager& downloadManager,
@@ -53,6 +53,11 @@ bool NativeResolver::resolve(Resolver::CallbackType callback)
 	return __impl->resolve(callback);
 }
 
+bool NativeResolver::checkInstallability(const BinaryVersion* version, string* failureReason)
+{
+	return __impl->checkInstallability(version, failureReason);
+}
+
 }
 }
 
@@ -139,7 +139,9 @@ VersionSource* createVersionSource(internal::CacheImpl* cacheImpl,
 	cacheImpl->binaryReleaseData.push_back(releaseInfo);
 
 	cacheImpl->releaseInfoAndFileStorage.push_back(make_pair(releaseInfo, file));
-	return &*(cacheImpl->releaseInfoAndFileStorage.rbegin());
+	auto result = &*(cacheImpl->releaseInfoAndFileStorage.rbegin());
+	cacheImpl->installedReleaseInfoAndFiles.push_back(result);
+	return result;
 }
 
 shared_ptr<File> StateData::openDpkgStatusFile() const
@@ -275,7 +277,7 @@ void StateData::parseDpkgStatus()
 				const auto& provides = parsed.provides;
 				if (!provides.empty())
 				{
-					cacheImpl->processProvides(&it->first,
+					cacheImpl->processProvides(&it->first, prePackageRecord,
 							&*(provides.begin()), &*(provides.end()));
 				}
 			}
@@ -54,6 +54,8 @@ our @EXPORT = qw(
 	get_offered_version
 	get_offered_versions
 	get_version_priority
+	compose_upgrade_with_alternatives
+	compose_interlocked_breaks
 	to_one_line
 	generate_file
 	get_keyring_path
@@ -803,6 +805,50 @@ sub get_version_priority {
 	return ($result // '');
 }
 
+# setup parameters of an upgrade where the best solution is found through
+# alternatives and a conflict
+sub compose_upgrade_with_alternatives {
+	return (
+		'dpkg_status' => [
+			compose_installed_record('aa', 1) . "Depends: bb (>= 1)\n",
+			compose_installed_record('bb', 1),
+			compose_installed_record('cc', 1) . "Depends: bb (<< 2)\n",
+		],
+		'packages' => [
+			compose_package_record('aa', 2) . "Depends: bb (>= 2) | dd\n",
+			compose_package_record('bb', 2) . "Conflicts: ee\n",
+			compose_package_record('cc', 2) . "Depends: bb (>= 2)\n",
+			compose_package_record('dd', 1) . "Depends: ee | ff\n",
+			compose_package_record('ee', 1),
+			compose_package_record('ff', 1),
+		],
+	);
+}
+
+# setup parameters of an upgrade of the packages p0..p<count-1>, where every
+# new version breaks the old versions of two other packages, so they may be
+# upgraded only all together; with the option 'recommends' every new version
+# also recommends a package r<i>, which conflicts with another one of them
+sub compose_interlocked_breaks {
+	my ($count, %options) = @_;
+
+	my @installed;
+	my @packages;
+	foreach my $i (0..$count-1) {
+		my $next = ($i + 7) % $count;
+		my $other = ($i * 13 + 5) % $count;
+		push @installed, compose_installed_record("p$i", 1);
+		my $record = compose_package_record("p$i", 2) . "Breaks: p$next (<< 2), p$other (<< 2)\n";
+		if ($options{'recommends'}//0) {
+			push @packages, $record . "Recommends: r$i\n";
+			push @packages, compose_package_record("r$i", 1) . "Conflicts: r$next\n";
+		} else {
+			push @packages, $record;
+		}
+	}
+	return ('dpkg_status' => \@installed, 'packages' => \@packages);
+}
+
 sub to_one_line {
 	my $t = shift;
 	$t =~ s/\n/{newline}/g;
@@ -0,0 +1,70 @@
+package ResolverBenchmark;
+
+# helpers shared by the resolver benchmarks
+
+use strict;
+use warnings;
+
+use POSIX ':sys_wait_h';
+use Time::HiRes qw(time sleep);
+
+our @EXPORT = qw(
+	measure
+	get_resolver_statistics
+);
+use Exporter qw(import);
+
+# runs a cupt command answering 'q' to its question, returns wall time in
+# seconds, peak resident memory in KiB and the exit code
+sub measure {
+	my ($command) = @_;
+
+	my $start = time();
+	my $pid = fork() // die "fork failed: $!";
+	if (!$pid) {
+		open(STDIN, '<', '/dev/null');
+		open(STDOUT, '>', '/dev/null');
+		open(STDERR, '>', '/dev/null');
+		exec('sh', '-c', "echo q | $command") or die;
+	}
+
+	my $peak_memory = 0;
+	while (waitpid($pid, WNOHANG) == 0) {
+		foreach my $child_pid (get_descendants($pid)) {
+			open(my $status, '<', "/proc/$child_pid/status") or next;
+			while (<$status>) {
+				if (m/^VmHWM:\s+(\d+)/ and $1 > $peak_memory) {
+					$peak_memory = $1;
+				}
+			}
+		}
+		sleep(0.002);
+	}
+	return (time() - $start, $peak_memory, $? >> 8);
+}
+
+sub get_descendants {
+	my ($pid) = @_;
+	my @result = ($pid);
+	foreach my $children_file (glob("/proc/$pid/task/*/children")) {
+		open(my $file, '<', $children_file) or next;
+		foreach my $child_pid (split(' ', <$file> // '')) {
+			push @result, get_descendants($child_pid);
+		}
+	}
+	return @result;
+}
+
+# runs a cupt command printing the resolver statistics, returns them as
+# a hash reference
+sub get_resolver_statistics {
+	my ($command) = @_;
+
+	# the statistics go to the standard error, separately from the question
+	my $output = `echo q | $command -o debug::resolver::statistics=yes 2>&1 >/dev/null`;
+	my %statistics = ($output =~ m/^D: resolver statistics: (\S+): (\S+)$/mg);
+	return \%statistics;
+}
+
+1;
+
@@ -0,0 +1,97 @@
+# Runs the resolver types over the same generated scenarios and compares
+# the final scores of the first offered solutions, the numbers of created
+# solutions and the run times.
+#
+# usage (from a build directory):
+#   perl -I<source>/test -MTestCupt <source>/test/benchmarks/resolver/compare-backends.pl <cupt binary> [size]
+
+use TestCupt;
+use FindBin;
+use lib $FindBin::Bin;
+use ResolverBenchmark;
+use Time::HiRes qw(time);
+
+use strict;
+use warnings;
+
+my $size = $ARGV[1] // 100;
+my @types = qw(fair estimated sat);
+my $time_limit = 600;
+
+# an upgrade where every package needs one of the libraries conflicting
+# with the libraries of the next package
+sub generate_conflicting_libraries {
+	my @installed;
+	my @available;
+	foreach my $i (0..$size-1) {
+		my $next = ($i + 1) % $size;
+		push @installed, compose_installed_record("p$i", 1) . "Depends: p$next (>= 1)\n";
+		push @available, compose_package_record("p$i", 2) .
+				"Depends: p$next (>= 2), a$i | b$i | c$i\n";
+		push @available, compose_package_record("a$i", 1) . "Conflicts: a$next, b$next\n";
+		push @available, compose_package_record("b$i", 1) . "Conflicts: b$next, c$next\n";
+		push @available, compose_package_record("c$i", 1) . "Conflicts: a$next, c$next\n";
+	}
+	return (setup('dpkg_status' => \@installed, 'packages' => \@available), 'full-upgrade');
+}
+
+# an upgrade where the new versions break the old versions of other
+# packages, so they may be upgraded only all together
+sub generate_interlocked_breaks {
+	return (setup(compose_interlocked_breaks($size, 'recommends' => 1)), 'full-upgrade');
+}
+
+# an installation of a package with random alternatives and conflicts
+sub generate_random_relations {
+	srand(42);
+	my @installed;
+	my @available;
+	my $random_package = sub { 'p' . int(rand($size)) };
+	foreach my $i (0..$size-1) {
+		if (rand() < 0.3) {
+			push @installed, compose_installed_record("p$i", 1);
+		}
+		foreach my $version (1, 2) {
+			my $record = compose_package_record("p$i", $version);
+			my @depends = map { join(' | ', $random_package->(), $random_package->()) } (1..2);
+			$record .= 'Depends: ' . join(', ', @depends) . "\n";
+			$record .= 'Conflicts: ' . $random_package->() . "\n" if rand() < 0.5;
+			push @available, $record;
+		}
+	}
+	return (setup('dpkg_status' => \@installed, 'packages' => \@available), 'install p0');
+}
+
+sub run_resolver {
+	my ($cupt, $command, $type) = @_;
+
+	my $full_command = "echo q | timeout $time_limit $cupt -s $command -o cupt::resolver::type=$type";
+	my $output = `$full_command -o debug::resolver=yes 2>&1`;
+	my ($score) = ($output =~ m/proposing this solution, final score (-?\d+)/);
+
+	my $start = time();
+	`$full_command 2>&1`;
+	my $time = time() - $start;
+
+	my $statistics = get_resolver_statistics("timeout $time_limit $cupt -s $command -o cupt::resolver::type=$type");
+
+	return ($score, $statistics->{'created-solutions'}, $time);
+}
+
+my @scenarios = (
+	[ 'conflicting libraries', \&generate_conflicting_libraries ],
+	[ 'interlocked breaks', \&generate_interlocked_breaks ],
+	[ 'random relations', \&generate_random_relations ],
+);
+
+printf("size: %d\n", $size);
+printf("%-24s %-9s %12s %10s %10s\n", 'scenario', 'type', 'score', 'solutions', 'time, s');
+foreach my $scenario (@scenarios) {
+	my ($name, $generator) = @$scenario;
+	my ($cupt, $command) = $generator->();
+	foreach my $type (@types) {
+		my ($score, $solutions, $time) = run_resolver($cupt, $command, $type);
+		printf("%-24s %-9s %12s %10s %10.3f\n", $name, $type, $score // 'none', $solutions // '-', $time);
+	}
+}
+
@@ -0,0 +1,56 @@
+# Measures time and memory per explored solution of the native resolver on
+# a generated upgrade of many interdependent packages.
+#
+# usage (from a build directory):
+#   perl -I<source>/test -MTestCupt <source>/test/benchmarks/resolver/large-upgrade.pl <cupt binary> [package count]
+
+use TestCupt;
+use FindBin;
+use lib $FindBin::Bin;
+use ResolverBenchmark;
+
+use strict;
+use warnings;
+
+my $package_count = $ARGV[1] // 400;
+my $run_count = 3;
+
+sub generate_scenario {
+	my @installed;
+	my @available;
+	foreach my $i (0..$package_count-1) {
+		my $next = ($i + 1) % $package_count;
+		push @installed, compose_installed_record("p$i", 1) . "Depends: p$next (>= 1)\n";
+		# every upgraded package needs one of the libraries, which conflict
+		# with the ones of the next package, except one
+		push @available, compose_package_record("p$i", 2) .
+				"Depends: p$next (>= 2), a$i | b$i | c$i\n";
+		push @available, compose_package_record("a$i", 1) . "Conflicts: a$next, b$next\n";
+		push @available, compose_package_record("b$i", 1) . "Conflicts: b$next, c$next\n";
+		push @available, compose_package_record("c$i", 1) . "Conflicts: a$next, c$next\n";
+	}
+	return setup('dpkg_status' => \@installed, 'packages' => \@available);
+}
+
+sub count_explored_solutions {
+	my ($cupt) = @_;
+	my $debug_output = `echo q | $cupt -s full-upgrade -o debug::resolver=yes 2>&1`;
+	my %ids = map { $_ => 1 } ($debug_output =~ m/^D:\s*\((\d+):-?\d+\) (?:problem|finished)/mg);
+	return scalar keys %ids;
+}
+
+my $cupt = generate_scenario();
+my $explored_solutions = count_explored_solutions($cupt) or die "no solutions explored";
+
+my ($best_time, $best_memory);
+foreach (1..$run_count) {
+	my ($time, $memory) = measure("$cupt -s full-upgrade");
+	$best_time = $time if (!defined $best_time or $time < $best_time);
+	$best_memory = $memory if (!defined $best_memory or $memory < $best_memory);
+}
+
+printf("packages: %d\n", $package_count);
+printf("explored solutions: %d\n", $explored_solutions);
+printf("time: %.3f s, %.1f us per solution\n", $best_time, $best_time * 1e6 / $explored_solutions);
+printf("peak memory: %d KiB, %.2f KiB per solution\n", $best_memory, $best_memory / $explored_solutions);
+
@@ -0,0 +1,114 @@
+# Generates a synthetic archive of many packages and measures the resolver
+# on install, remove and dist-upgrade scenarios against it: wall time, peak
+# memory, time of the search itself, created solutions, leaves of the
+# solution tree (finished solutions and dead ends) and restarts after hitting
+# the leaf limit.
+#
+# The archive consists of lock-step dependency chains, where every new
+# version needs the new version of the next package in the chain, with some
+# packages also depending on virtual packages, on Multi-Arch: allowed
+# packages with ':any', and on alternatives conflicting with the ones of the
+# packages further in the archive. Some packages have versions of a foreign
+# architecture too. The last chains are not installed.
+#
+# usage (from a build directory):
+#   perl -I<source>/test -MTestCupt <source>/test/benchmarks/resolver/scenarios.pl <cupt binary> [package count] [run count]
+
+use TestCupt;
+use FindBin;
+use lib $FindBin::Bin;
+use ResolverBenchmark;
+
+use strict;
+use warnings;
+
+my $package_count = $ARGV[1] // 10000;
+my $run_count = $ARGV[2] // 1;
+my $chain_length = 50;
+my $virtual_package_count = 50;
+my $time_limit = 600;
+
+my $installed_count = int($package_count * 0.8 / $chain_length) * $chain_length;
+
+sub compose_relations {
+	my ($i, $version) = @_;
+
+	my @depends;
+	if ($i % $chain_length != $chain_length-1 and $i+1 < $package_count) {
+		push @depends, 'p' . ($i+1) . " (>= $version)";
+	}
+	if ($i % 11 == 5) {
+		push @depends, 'v' . ($i % $virtual_package_count);
+	}
+	if ($i % 13 == 1) {
+		push @depends, 'p' . ($i-1) . ':any';
+	}
+	if ($version == 2 and $i % 17 == 3) {
+		push @depends, "a$i | b$i";
+	}
+
+	my $result = '';
+	$result .= 'Depends: ' . join(', ', @depends) . "\n" if @depends;
+	$result .= 'Provides: v' . (int($i/7) % $virtual_package_count) . "\n" if $i % 7 == 0;
+	$result .= "Multi-Arch: allowed\n" if $i % 13 == 0;
+	return $result;
+}
+
+sub generate_archive {
+	my @installed;
+	my @available;
+	foreach my $i (0..$package_count-1) {
+		if ($i < $installed_count) {
+			push @installed, compose_installed_record("p$i", 1) . compose_relations($i, 1);
+		}
+		foreach my $version (1, 2) {
+			my $relations = compose_relations($i, $version);
+			push @available, compose_package_record("p$i", $version) . $relations;
+			if ($i % 13 == 0) {
+				push @available, compose_package_record("p$i", $version, 'architecture' => 'dubidu') . $relations;
+			}
+		}
+		if ($i % 17 == 3) {
+			push @available, compose_package_record("a$i", 1) . 'Conflicts: a' . (($i+17) % $package_count) . "\n";
+			push @available, compose_package_record("b$i", 1);
+		}
+	}
+	return setup('dpkg_status' => \@installed, 'packages' => \@available);
+}
+
+my @scenarios = (
+	# pulls a whole not installed chain
+	[ 'install', "install p$installed_count" ],
+	# the rest of the chain depends on the last package of it
+	[ 'remove', 'remove p' . ($installed_count-1) ],
+	[ 'dist-upgrade', 'full-upgrade' ],
+);
+
+my $cupt = generate_archive();
+
+printf("packages: %d, installed: %d\n", $package_count, $installed_count);
+printf("%-14s %10s %12s %10s %10s %8s %10s %8s\n",
+		'scenario', 'time, s', 'memory, KiB', 'search, s', 'solutions', 'leaves', 'duplicates', 'restarts');
+foreach my $scenario (@scenarios) {
+	my ($name, $command) = @$scenario;
+	my $full_command = "timeout $time_limit $cupt -s $command";
+
+	my ($best_time, $best_memory, $exit_code);
+	foreach (1..$run_count) {
+		my ($time, $memory);
+		($time, $memory, $exit_code) = measure($full_command);
+		$best_time = $time if (!defined $best_time or $time < $best_time);
+		$best_memory = $memory if (!defined $best_memory or $memory < $best_memory);
+	}
+	if ($exit_code == 124) {
+		printf("%-14s %10s\n", $name, 'timeout');
+		next;
+	}
+
+	my $statistics = get_resolver_statistics($full_command);
+	printf("%-14s %10.3f %12d %10.3f %10d %8d %10d %8d\n", $name, $best_time, $best_memory,
+			$statistics->{'search-time'}, $statistics->{'created-solutions'},
+			$statistics->{'discarded-solutions'} + $statistics->{'proposed-solutions'},
+			$statistics->{'duplicate-solutions'}, $statistics->{'restarts'});
+}
+
@@ -0,0 +1,9 @@
+#!/bin/sh
+
+set -e
+
+TESTS_PATH=$1
+RUNNER="perl -Mwarnings -Mstrict -I${TESTS_PATH} -MTestCupt"
+BINARY_UNDER_TEST_PATH=${BENCHMARK_BINARY:-$2}
+
+$RUNNER $TESTS_PATH/benchmarks/resolver/scenarios.pl "$BINARY_UNDER_TEST_PATH" $BENCHMARK_PARAMS
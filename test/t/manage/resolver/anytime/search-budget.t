@@ -0,0 +1,42 @@
+use TestCupt;
+use Test::More tests => 9;
+
+use strict;
+use warnings;
+
+# many branches of the solution tree end in dead ends, so it takes long to
+# find a solution
+my $count = 16;
+my $cupt = setup(compose_interlocked_breaks($count, 'recommends' => 1));
+
+my $budget_warning = qr/^W: the resolver has exhausted its search budget/m;
+
+sub get_offer {
+	my ($options, $max_leaf_count) = @_;
+	$max_leaf_count //= 30;
+	return get_first_offer("$cupt full-upgrade -o cupt::resolver::max-leaf-count=$max_leaf_count $options");
+}
+
+my $offer = get_offer('');
+like($offer, qr/leaf count limit exceeded/, 'the leaf limit is fatal by default');
+unlike($offer, $budget_warning, 'no anytime mode by default');
+
+$offer = get_offer('-o cupt::resolver::time-limit=600');
+like($offer, regex_offer(), 'the leaf limit gives a solution in the anytime mode');
+like($offer, $budget_warning, 'exhausting the search budget is reported');
+my @upgraded = grep { get_offered_version($offer, "p$_") eq '2' } (0..$count-1);
+ok(scalar @upgraded > 0, 'the offered solution does something useful');
+
+$offer = get_offer('-o cupt::resolver::time-limit=600 -o cupt::resolver::type=full');
+like($offer, regex_offer(), "the 'full' resolver type gives a solution too");
+
+$offer = get_offer('-o cupt::resolver::time-limit=600', 5);
+like($offer, qr/^E: the resolver has exhausted its search budget while completing a solution$/m,
+		'completing a solution is bounded too');
+
+my $simple_cupt = setup(
+	'packages' => [ compose_package_record('aa', 1) . "Depends: bb\n", compose_package_record('bb', 1) ],
+);
+$offer = get_first_offer("$simple_cupt install aa -o cupt::resolver::time-limit=600");
+like($offer, regex_offer(), 'resolving within the budget succeeded');
+unlike($offer, $budget_warning, 'the search budget is not exhausted');
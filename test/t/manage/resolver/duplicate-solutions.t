@@ -0,0 +1,52 @@
+use TestCupt;
+use Test::More tests => 6;
+
+use strict;
+use warnings;
+
+sub get_offers {
+	my ($cupt, $drop_duplicates) = @_;
+
+	my $output = get_all_offers("$cupt -o debug::resolver::statistics=yes " .
+			"-o cupt::resolver::drop-duplicate-solutions=$drop_duplicates install");
+	my ($duplicates) = ($output =~ m/D: resolver statistics: duplicate-solutions: (\d+)$/m);
+	$output =~ s/D: .*\n//g;
+
+	my @versions = map {
+		join(' ', get_offered_version($_, 'aa'), get_offered_version($_, 'cc'))
+	} split_offers($output);
+	return (\@versions, $duplicates);
+}
+
+sub uniq {
+	my %seen;
+	return [ grep { !$seen{$_}++ } @{$_[0]} ];
+}
+
+sub test {
+	my ($installed_record, $expected_offers, $expected_duplicates, $comment) = @_;
+
+	my $cupt = setup(
+		'dpkg_status' => [ $installed_record ],
+		'packages' => [ compose_package_record('aa', 2), compose_package_record('cc', 1) ],
+	);
+
+	my ($offers, $duplicates) = get_offers($cupt, 'yes');
+	my ($all_offers) = get_offers($cupt, 'no');
+
+	is_deeply($offers, $expected_offers, "$comment: offers") or diag("@$offers");
+	is($duplicates, $expected_duplicates, "$comment: dropped duplicates");
+	is_deeply(uniq($offers), uniq($all_offers), "$comment: the same offers without dropping duplicates");
+}
+
+my $unchanged = get_unchanged_version();
+my $removed = get_empty_version();
+
+# the upgrade of 'aa' both satisfies the dependency and changes the depending version
+test(compose_installed_record('aa', 1) . "Depends: aa (>= 2)\n",
+		[ "2 $unchanged", "$removed $unchanged" ], 1, 'the same change twice');
+
+# changing the depending version rejects 'cc', which satisfying the dependency doesn't
+test(compose_installed_record('aa', 1) . "Depends: aa (>= 2) | cc\n",
+		[ "2 $unchanged", "2 $unchanged", "$unchanged 1", "$removed $unchanged" ], 0,
+		'the same change, different rejections');
@@ -0,0 +1,48 @@
+use TestCupt;
+use Test::More tests => 2;
+
+use strict;
+use warnings;
+
+sub get_offer {
+	my ($cupt, $command, $type) = @_;
+	return get_first_offer("$cupt -o cupt::resolver::type=$type $command");
+}
+
+subtest "the same offer as the fair resolver" => sub {
+	my $cupt = setup(compose_upgrade_with_alternatives());
+
+	my $offer = get_offer($cupt, 'full-upgrade', 'estimated');
+	like($offer, regex_offer(), 'resolving succeeded');
+	is($offer, get_offer($cupt, 'full-upgrade', 'fair'), 'the offers are equal');
+};
+
+subtest "solutions carrying a costly problem are postponed" => sub {
+	# the wish is processed after the dependencies, so the solutions which
+	# haven't decided on it yet carry it while their recommendations are
+	# decided
+	my $cupt = setup(
+		'dpkg_status' => [
+			compose_installed_record('kk', 1),
+		],
+		'packages' => [
+			compose_package_record('aa', 1) .
+					"Depends: q1 | q2, r1 | r2, s1 | s2\nRecommends: t1 | t2, u1 | u2, v1 | v2\n",
+			map { compose_package_record($_, 1) } qw(q1 q2 r1 r2 s1 s2 t1 t2 u1 u2 v1 v2),
+		],
+	);
+	my $command = 'install aa --wish --remove kk';
+
+	my $offer = get_offer($cupt, $command, 'estimated');
+	like($offer, regex_offer(), 'resolving succeeded');
+	is($offer, get_offer($cupt, $command, 'fair'), 'the offers are equal');
+
+	my $get_created_solution_count = sub {
+		my ($type) = @_;
+		my $output = get_offer($cupt, "$command -o debug::resolver::statistics=yes", $type);
+		my ($result) = ($output =~ m/D: resolver statistics: created-solutions: (\d+)$/m);
+		return $result;
+	};
+	cmp_ok($get_created_solution_count->('estimated'), '<', $get_created_solution_count->('fair'),
+			'fewer solutions are created');
+};
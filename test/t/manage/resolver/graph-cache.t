@@ -0,0 +1,59 @@
+use TestCupt;
+use Test::More tests => 8;
+
+use strict;
+use warnings;
+
+my $packages = [
+	compose_package_record('aa', 2) . "Depends: xx | bb, vv\n",
+	compose_package_record('bb', 1),
+	compose_package_record('pp', 1) . "Provides: vv\n",
+	compose_package_record('qq', 1) . "Provides: vv\n",
+];
+sub setup_with {
+	my ($installed, $packages) = @_;
+	return setup(
+		'dpkg_status' => $installed,
+		'packages' => $packages,
+	);
+}
+
+# outside of the environment, which is recreated by every setup
+my $cache_dir = '../graph-cache';
+system("rm -rf $cache_dir");
+
+sub get_offer_and_hits {
+	my ($cupt) = @_;
+	my $output = get_first_offer("$cupt full-upgrade -o debug::resolver::statistics=yes " .
+			"-o cupt::resolver::graph-cache-directory=$cache_dir");
+	my ($hits) = ($output =~ m/D: resolver statistics: graph-cache-hits: (\d+)$/m);
+	$output =~ s/D: .*\n//g;
+	return ($output, $hits);
+}
+
+sub test_offer_and_hits {
+	my ($cupt, $expected_hits, $description) = @_;
+	my ($offer, $hits) = get_offer_and_hits($cupt);
+	is($offer, get_first_offer("$cupt full-upgrade"), "$description: the offer is the same as without the cache");
+	$expected_hits->($hits);
+}
+
+my $cupt = setup_with([ compose_installed_record('aa', 1) ], $packages);
+test_offer_and_hits($cupt, sub { is($_[0], 0, 'nothing is stored at first') }, 'first run');
+test_offer_and_hits($cupt, sub { cmp_ok($_[0], '>', 0, 'the stored versions are used') }, 'second run');
+
+# the same indexes, but the dependencies are satisfied by the versions which
+# are only installed now
+$cupt = setup_with([
+	compose_installed_record('aa', 1),
+	compose_installed_record('xx', 1),
+	compose_installed_record('rr', 1) . "Provides: vv\n",
+], $packages);
+test_offer_and_hits($cupt, sub { cmp_ok($_[0], '>', 0, 'the stored versions are shared between installed systems') },
+		'other installed packages');
+
+$cupt = setup_with([ compose_installed_record('aa', 1) ], [ @$packages, compose_package_record('ee', 1) ]);
+test_offer_and_hits($cupt, sub { is($_[0], 0, 'changed indexes have their own versions') }, 'changed indexes');
+
+system("rm -rf $cache_dir");
+
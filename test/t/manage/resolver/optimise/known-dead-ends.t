@@ -0,0 +1,16 @@
+use TestCupt;
+use Test::More tests => 2;
+
+use strict;
+use warnings;
+
+# every new version breaks the old versions of two other packages, so many
+# branches of the solution tree end in the same dead ends
+my $count = 16;
+my $cupt = setup(compose_interlocked_breaks($count, 'recommends' => 1));
+
+my $offer = get_first_offer("$cupt full-upgrade -o cupt::resolver::max-leaf-count=2000");
+like($offer, regex_offer(), 'resolving succeeded within the leaf limit');
+
+my @upgraded = grep { get_offered_version($offer, "p$_") eq '2' } (0..$count-1);
+is(scalar @upgraded, $count, 'all packages are upgraded');
@@ -0,0 +1,45 @@
+use TestCupt;
+use Test::More tests => 6;
+
+use strict;
+use warnings;
+
+my $binary_arch = get_binary_architecture();
+
+my $cupt = setup(
+	'packages' => [
+		compose_package_record('aa', 1, 'architecture' => $binary_arch) . "Provides: pp\n",
+		compose_package_record('aa', 2, 'architecture' => 'dubidu') . "Provides: pp, qq\n",
+		compose_package_record('bb', 3, 'architecture' => 'dubidu') . "Provides: pp\n",
+	],
+);
+
+sub test {
+	my ($relation, $expected_result) = @_;
+
+	my $output = get_all_offers("$cupt satisfy '$relation'");
+
+	my @versions = map { get_offered_version($_, 'aa') } split_offers($output);
+
+	is_deeply(\@versions, $expected_result, "relation: '$relation'") or diag($output);
+}
+
+test('pp' => [ '1' ]);
+test('qq' => []);
+
+my $package_names = stdall("$cupt pkgnames");
+like($package_names, qr/^aa$/m, "package with a native version is listed");
+unlike($package_names, qr/^bb$/m, "package with only foreign versions is not listed");
+
+my $installed_record = compose_installed_record('cc', 4);
+$installed_record =~ s/^Architecture: .*$/Architecture: dubidu/m;
+$cupt = setup(
+	'dpkg_status' => [ $installed_record ],
+	'packages' => [
+		compose_package_record('cc', 4, 'architecture' => 'dubidu'),
+		compose_package_record('cc', 5, 'architecture' => 'dubidu'),
+	],
+);
+my $policy = stdall("$cupt policy cc");
+like($policy, qr/^  Installed: 4\^installed$/m, "installed version of a foreign architecture is kept") or diag($policy);
+like(stdall("$cupt pkgnames"), qr/^cc$/m, "installed package of a foreign architecture is listed");
@@ -0,0 +1,37 @@
+use TestCupt;
+use Test::More tests => 3;
+
+use strict;
+use warnings;
+
+my $record = compose_package_record('aa', 1) . "Provides: pp (= 10), qq\n";
+
+my $cupt = setup(
+	'dpkg_status' => [
+		compose_installed_record('bb', 2) . "Provides: pp\n",
+	],
+	'releases' => [
+		{
+			'archive' => 'one',
+			'packages' => [ $record ],
+		},
+		{
+			'archive' => 'two',
+			'packages' => [ $record, compose_package_record('aa', 2) . "Provides: pp (= 20)\n" ],
+		},
+	],
+);
+
+sub test {
+	my ($relation, $expected_result) = @_;
+
+	my $output = get_all_offers("$cupt satisfy '$relation'");
+
+	my @versions = map { get_offered_version($_, 'aa') } split_offers($output);
+
+	is_deeply(\@versions, $expected_result, "relation: '$relation'") or diag($output);
+}
+
+test('pp (= 10)' => [ '1' ]);
+test('pp (>= 10)' => [ qw(2 1) ]);
+test('qq' => [ '1' ]);
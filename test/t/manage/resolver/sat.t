@@ -0,0 +1,54 @@
+use TestCupt;
+use Test::More tests => 4;
+
+use strict;
+use warnings;
+
+sub get_offer {
+	my ($cupt, $command, $type) = @_;
+	return get_first_offer("$cupt -o cupt::resolver::type=$type $command");
+}
+
+subtest "the same offer as the tree search" => sub {
+	my $cupt = setup(compose_upgrade_with_alternatives());
+
+	my $offer = get_offer($cupt, 'full-upgrade', 'sat');
+	like($offer, regex_offer(), 'resolving succeeded');
+	is($offer, get_offer($cupt, 'full-upgrade', 'fair'), 'the offers are equal');
+};
+
+subtest "unsatisfied recommends are avoided" => sub {
+	my $cupt = setup(
+		'packages' => [
+			compose_package_record('aa', 1) . "Recommends: bb | cc\n",
+			compose_package_record('bb', 1) . "Conflicts: dd\n",
+			compose_package_record('cc', 1),
+			compose_package_record('dd', 1),
+		],
+	);
+
+	my $offer = get_offer($cupt, 'install aa dd', 'sat');
+	is(get_offered_version($offer, 'aa'), 1, "'aa' is installed");
+	is(get_offered_version($offer, 'dd'), 1, "'dd' is installed");
+	is(get_offered_version($offer, 'cc'), 1, "the recommendation is satisfied by 'cc'");
+};
+
+subtest "interlocked breaks are resolved" => sub {
+	my $cupt = setup(compose_interlocked_breaks(20));
+
+	my $offer = get_offer($cupt, 'full-upgrade', 'sat');
+	my @upgraded = grep { get_offered_version($offer, "p$_") eq '2' } (0..19);
+	is(scalar @upgraded, 20, 'all packages are upgraded');
+};
+
+subtest "no solutions" => sub {
+	my $cupt = setup(
+		'packages' => [
+			compose_package_record('aa', 1) . "Depends: bb\n",
+			compose_package_record('bb', 1) . "Conflicts: aa\n",
+		],
+	);
+
+	my $output = get_offer($cupt, 'install aa', 'sat');
+	like($output, regex_no_solutions(), 'resolving failed');
+};
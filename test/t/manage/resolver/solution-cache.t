@@ -0,0 +1,55 @@
+use TestCupt;
+use Test::More tests => 7;
+
+use strict;
+use warnings;
+
+my $packages = [
+	compose_package_record('aa', 2) . "Depends: bb | cc\n",
+	compose_package_record('bb', 1),
+	compose_package_record('cc', 1),
+	compose_package_record('dd', 1),
+];
+sub setup_with_packages {
+	return setup(
+		'dpkg_status' => [
+			compose_installed_record('aa', 1),
+		],
+		'packages' => $_[0],
+	);
+}
+my $cupt = setup_with_packages($packages);
+
+my $cache_dir = 'solution-cache';
+system("rm -rf $cache_dir");
+
+# the solutions are cached only when accepted
+sub get_offer_and_hits {
+	my ($arguments) = @_;
+	my $output = `echo 'y' | $cupt $arguments -s -o debug::resolver::statistics=yes -o cupt::resolver::solution-cache-directory=$cache_dir 2>&1`;
+	my ($hits) = ($output =~ m/D: resolver statistics: solution-cache-hits: (\d+)$/m);
+	$output =~ s/D: .*\n//g; # may follow the question on the same line
+	return ($output, $hits);
+}
+
+my ($first_offer, $first_hits) = get_offer_and_hits('full-upgrade');
+is($first_hits, 0, 'nothing is cached at first');
+
+my ($second_offer, $second_hits) = get_offer_and_hits('full-upgrade');
+is($second_hits, 1, 'the accepted solution is proposed from the cache');
+is($second_offer, $first_offer, 'the cached solution is the same');
+
+my (undef, $other_request_hits) = get_offer_and_hits('install dd');
+is($other_request_hits, 0, 'other requests have their own solutions');
+
+my (undef, $other_options_hits) = get_offer_and_hits('full-upgrade -o cupt::resolver::score::new=-500');
+is($other_options_hits, 0, 'other resolver options have their own solutions');
+
+
+system('touch --date=2001-01-01 env/var/lib/cupt/lists/*');
+my (undef, $touched_hits) = get_offer_and_hits('full-upgrade');
+is($touched_hits, 1, 'file times of the indexes are not a part of the key');
+
+$cupt = setup_with_packages([ @$packages, compose_package_record('ee', 1) ]);
+my (undef, $changed_index_hits) = get_offer_and_hits('full-upgrade');
+is($changed_index_hits, 0, 'changed indexes have their own solutions');
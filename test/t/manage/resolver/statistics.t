@@ -0,0 +1,35 @@
+use TestCupt;
+use Test::More tests => 10;
+
+use strict;
+use warnings;
+
+my $cupt = setup(
+	'packages' => [
+		compose_package_record('aa', 1) . "Depends: bb | cc\n",
+		compose_package_record('bb', 1) . "Conflicts: dd\n",
+		compose_package_record('cc', 1),
+		compose_package_record('dd', 1),
+	],
+);
+
+sub get_statistics {
+	my ($arguments) = @_;
+	my $output = get_first_offer("$cupt install aa dd $arguments");
+	my %statistics = ($output =~ m/D: resolver statistics: (\S+): (\S+)$/mg);
+	return (\%statistics, $output);
+}
+
+my ($statistics, $output) = get_statistics('-o debug::resolver::statistics=yes');
+like($output, regex_offer(), 'resolving succeeded');
+is($statistics->{'proposed-solutions'}, 1, 'one solution is proposed');
+is($statistics->{'discarded-solutions'}, 1, "the one with 'bb' is discarded");
+is($statistics->{'created-solutions'}, 4, 'four solutions are created');
+is($statistics->{'steps'}, 4, 'two requests and two dependencies are processed');
+is($statistics->{'max-step-actions'}, 2, 'both alternatives are tried');
+ok($statistics->{'unfolded-elements'} <= $statistics->{'graph-vertices'}, 'unfolded elements are graph vertices');
+like($statistics->{'search-time'}, qr/^\d+\.\d+$/, 'search time is printed');
+is($statistics->{'duplicate-solutions'}, 0, 'no duplicate solutions');
+
+($statistics, $output) = get_statistics('');
+is_deeply($statistics, {}, 'no statistics by default');
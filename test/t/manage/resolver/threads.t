@@ -0,0 +1,17 @@
+use TestCupt;
+use Test::More tests => 2;
+
+use strict;
+use warnings;
+
+my $cupt = setup(compose_upgrade_with_alternatives());
+
+sub get_offers {
+	my ($threads) = @_;
+	return get_all_offers("$cupt -o cupt::resolver::threads=$threads full-upgrade");
+}
+
+my $sequential_offers = get_offers(1);
+like($sequential_offers, regex_offer(), "resolving succeeded");
+is(get_offers(4), $sequential_offers, "the same offers with several threads");
+
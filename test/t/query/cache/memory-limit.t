@@ -0,0 +1,55 @@
+use TestCupt;
+use CuptInteractive;
+use Test::More tests => 8;
+
+use strict;
+use warnings;
+
+my $packages;
+foreach my $index (1..50) {
+	$packages .= entail(compose_package_record("pkg$index", '1') .
+			"Provides: virtual\nDescription: package number $index\n");
+	$packages .= entail(compose_package_record("pkg$index", '2') .
+			"Depends: virtual\nDescription: package number $index, updated\n");
+}
+
+my $cupt = TestCupt::setup('packages' => $packages);
+
+sub get_output {
+	my ($command, $limit) = @_;
+	my $output = `$cupt $command -o cupt::cache::memory-limit=$limit 2>&1`;
+	return $output;
+}
+
+my $unlimited = get_output("search 'package number'", 0);
+is(scalar(() = $unlimited =~ /\n/g), 100, 'all versions are found without memory limit');
+is(get_output("search 'package number'", 1), $unlimited, 'search output is the same with memory limit');
+
+my $stats = get_output('cache-stats --parse-all', 1);
+like($stats, qr/^Parsed packages: /m, 'parsed packages are accounted');
+like($stats, qr/^Total: /m, 'total is printed');
+
+sub get_size {
+	my ($stats, $line) = @_;
+	my ($number, $unit) = ($stats =~ /^$line: ([\d.]+)(\w+)$/m);
+	return $number * ($unit eq 'KiB' ? 1024 : 1);
+}
+
+cmp_ok(get_size(get_output('cache-stats --parse-all', 0), 'Unparsed package records'), '<',
+		get_size($stats, 'Unparsed package records'), 'index records are kept only with memory limit');
+
+is(get_output('depends --recurse pkg50', 1), get_output('depends --recurse pkg50', 0),
+		'memoized relations give the same output with memory limit');
+
+sub get_shell_stats_after_depends {
+	my ($limit) = @_;
+	my $cupt_shell = CuptInteractive->new("$cupt shell -o cupt::cache::memory-limit=$limit");
+	$cupt_shell->execute('cache-stats');
+	$cupt_shell->execute('depends --recurse pkg50');
+	return $cupt_shell->execute('cache-stats');
+}
+
+my $shell_unlimited = get_size(get_shell_stats_after_depends(0), 'Parsed packages');
+my $shell_limited = get_size(get_shell_stats_after_depends(1), 'Parsed packages');
+cmp_ok($shell_unlimited, '>', 1024, 'packages stay parsed between shell commands without memory limit');
+cmp_ok($shell_limited, '<=', 1024, 'packages are discarded before the next shell command with memory limit');
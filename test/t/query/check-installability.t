@@ -0,0 +1,56 @@
+use TestCupt;
+use Test::More tests => 10;
+
+use strict;
+use warnings;
+
+my $cupt = setup(
+	'dpkg_status' => [
+		compose_installed_record('ii', 1) ,
+		compose_installed_record('jj', 1) . "Depends: ii\n" ,
+	],
+	'packages' => [
+		compose_package_record('aa', 1) . "Depends: bb\n" ,
+		compose_package_record('bb', 1) ,
+		compose_package_record('cc', 1) . "Depends: dd\n" ,
+		compose_package_record('ee', 1) . "Conflicts: ii\n" ,
+		compose_package_record('ff', 1) . "Depends: gg (>= 2)\n" ,
+		compose_package_record('gg', 1) ,
+		compose_package_record('hh', 1) . "Conflicts: aa\n" ,
+		compose_package_record('kk', 1) . "Depends: ll\n" ,
+		compose_package_record('ll', 1) . "Depends: gg (>= 2)\n" ,
+		compose_package_record('mm', 1) . "Depends: ll\n" ,
+	],
+);
+
+sub check {
+	my ($arguments) = @_;
+	my $output = stdall("$cupt check-installability $arguments");
+	return ($output, $?);
+}
+
+my ($output, $exit_code) = check('aa bb');
+is($output, "aa 1: installable\nbb 1: installable\n", 'installable versions') or diag($output);
+is($exit_code, 0, 'success if all versions are installable');
+
+($output, $exit_code) = check('cc');
+like($output, qr/^cc 1: not installable, because of:\n.+dd/s, 'missing dependency') or diag($output);
+isnt($exit_code, 0, 'failure if some version is not installable');
+
+($output) = check('ff');
+like($output, qr/^ff 1: not installable/, 'unsatisfiable versioned dependency') or diag($output);
+
+($output) = check('ee');
+like($output, qr/^ee 1: installable$/m, 'installed packages may be removed') or diag($output);
+
+($output) = check('hh aa cc bb');
+like($output, qr/^hh 1: installable\naa 1: installable\ncc 1: not installable.*\nbb 1: installable\n$/s,
+		'versions are checked independently of each other, in the given order') or diag($output);
+
+my ($parallel_output, $parallel_exit_code) = check('--jobs=3 hh aa cc bb');
+is($parallel_output, $output, 'the same results with several jobs');
+isnt($parallel_exit_code, 0, 'the same exit code with several jobs');
+
+($output) = check('kk mm');
+like($output, qr/^mm 1: not installable, because of:\nmm 1 depends on 'll'/m,
+		'the reason is given for a dead end known from a previous check') or diag($output);
@@ -0,0 +1,26 @@
+use Test::More tests => 5;
+
+require(get_rinclude_path('common'));
+
+my $cupt = setup(
+	'releases' => [{
+		'location' => 'remote',
+		'archive' => 'aaa',
+		'label' => 'lll',
+		'packages' => [ compose_package_record('abc', 1) ],
+	}],
+);
+
+my $lists_dir = 'var/lib/cupt/lists';
+
+check_exit_code("$cupt update", 1, 'metadata update succeeded');
+
+my @compact_paths = glob("$lists_dir/*Release.info*");
+is(scalar @compact_paths, 1, 'compact release info is generated') or diag(`ls $lists_dir`);
+
+my $policy_with_compact_info = stdall("$cupt policy");
+unlink(@compact_paths);
+is(stdall("$cupt policy"), $policy_with_compact_info, 'compact release info gives the same release data');
+
+check_exit_code("$cupt update", 1, 'metadata update succeeded');
+ok(-e $compact_paths[0], 'compact release info is generated again');
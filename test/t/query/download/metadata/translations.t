@@ -10,7 +10,7 @@ sub get_translation_record_for_lang {
 sub fetch_pair_if_translation {
 	my $tr_path_prefix = '_aaa_ccc_i18n_Translation';
 
-	return () if m/index0/;
+	return () if m/index1/;
 	my ($lang) = m/$tr_path_prefix-(.*)/;
 	return () unless defined($lang);
 
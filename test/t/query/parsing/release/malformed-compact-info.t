@@ -0,0 +1,25 @@
+use Test::More tests => 4;
+
+my $cupt = setup(
+	'releases' => [{
+		'archive' => 'aaa',
+		'label' => 'lll',
+		'packages' => [ compose_package_record('abc', 1) ],
+	}],
+);
+
+my ($release_path) = glob('var/lib/cupt/lists/*Release');
+my $compact_path = "$release_path.info0";
+
+my $policy = stdall("$cupt policy");
+like($policy, qr/a=aaa/, 'the release is parsed');
+
+open(my $compact_file, '>', $compact_path) or die;
+print $compact_file "1.0\ntruncated\n";
+close($compact_file);
+
+my $output = stdall("$cupt policy");
+like($output, qr/^W: discarding the malformed compact release info '.*\Q$compact_path\E'$/m, 'a warning is printed');
+$output =~ s/^W: .*\n//mg;
+is($output, $policy, 'the full release is parsed instead');
+ok(! -e $compact_path, 'the malformed compact release info is removed');
@@ -0,0 +1,43 @@
+use Test::More tests => 9;
+
+require(get_rinclude_path('common'));
+
+my $packages = [
+	compose_package_record('abc', 1),
+	compose_package_record('abc', 2),
+	compose_package_record('xyz', 3) . "Depends: virt\n",
+];
+
+my $cupt = setup(
+	'dpkg_status' => [
+		compose_installed_record('abc', 1),
+		compose_installed_record('def', 4) . "Provides: virt\n",
+		compose_installed_record('jkl', 6),
+	],
+	'packages' => $packages,
+);
+my $cupt_shell = get_shell($cupt);
+
+# parse the affected and the unchanged packages before the system change
+$cupt_shell->execute('show abc def jkl xyz');
+$cupt_shell->execute('rdepends virt');
+
+$cupt_shell->execute('remove -y def');
+$cupt = setup(
+	'dpkg_status' => [
+		compose_installed_record('abc', 2),
+		compose_installed_record('ghi', 5) . "Provides: virt\n",
+		compose_installed_record('jkl', 6),
+	],
+	'extended_states' => [
+		compose_autoinstalled_record('abc'),
+	],
+	'packages' => $packages,
+);
+
+foreach my $command ('policy jkl', 'remove -s -y jkl', 'policy abc', 'show ghi', 'pkgnames', 'showauto', 'policy',
+		'depends --recurse xyz', 'remove -s -y abc') {
+	subtest "'$command' after the system change" => sub {
+		test_output_identical_with_non_shell($cupt, $cupt_shell, $command);
+	}
+}